@@ -30,7 +30,10 @@
 ============================================================================= */
 bool LIDARLite::errorReporting = false;
 
-LIDARLite::LIDARLite(){}
+LIDARLite::LIDARLite(){
+  profileReadCount = 0;
+  correlationStreamAddress = 0x00;
+}
 
 /* =============================================================================
 
@@ -62,6 +65,7 @@ LIDARLite::LIDARLite(){}
 ============================================================================= */
 void LIDARLite::begin(int configuration, bool fasti2c, bool showErrorReporting, char LidarLiteI2cAddress){
   errorReporting = showErrorReporting;
+  correlationStreamAddress = 0x00; // A restarted sensor is out of test mode
   Wire.begin(); //  Start I2C
   if(fasti2c){
     #if ARDUINO >= 157
@@ -110,6 +114,56 @@ void LIDARLite::configure(int configuration, char LidarLiteI2cAddress){
   }
 }
 
+/* =============================================================================
+
+  Configure with a Profile
+
+  The presets above each change a single register. A profile sets every
+  register that trades speed against noise directly, so the tradeoff can be
+  chosen (or found with tune() below) instead of guessed.
+
+  Process
+  ------------------------------------------------------------------------------
+  1.  Write the acquisition count to register 0x02
+  2.  Write the detection threshold to register 0x1c
+  3.  Write the measurement interval to register 0x45
+  4.  Restart the count used to decide which readings get DC stabilization
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - profile: a LIDARLiteProfile with
+    - acquisitionCount: maximum number of acquisitions per measurement
+      (register 0x02), default 0x80. Fewer is faster but noisier.
+    - threshold: detection threshold (register 0x1c), default 0x00. 0x20 is
+      the low noise/low sensitivity preset (configure(2)), 0x60 the high
+      noise/high sensitivity preset (configure(3)).
+    - stabilizeEvery: take 1 out of every stabilizeEvery readings with DC
+      stabilization (0x04 to register 0x00), the rest without (0x03), see
+      distance(). 1 or 0 stabilizes every reading. This is the only preamp
+      control a profile has, there is no separate reference pulse setting
+      (distance() ignores its takeReference flag).
+    - interval: time between measurements in continuous mode (register 0x45),
+      default 0xc8. It has no effect on single readings. This is the same
+      register scale() uses for velocity scaling, so applying a profile
+      overwrites the velocity scaling value.
+  - LidarLiteI2cAddress (optional): Default: 0x62, the default LIDAR-Lite
+    address. If you change the address, fill it in here.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Half the default acquisition count, stabilize 1 in 10 readings
+      LIDARLiteProfile quickProfile = {0x40, 0x00, 10, 0xc8};
+      myLidarLiteInstance.configure(quickProfile);
+      int distance = myLidarLiteInstance.distance(quickProfile);
+
+============================================================================= */
+void LIDARLite::configure(const LIDARLiteProfile &profile, char LidarLiteI2cAddress){
+  write(0x02,profile.acquisitionCount,LidarLiteI2cAddress);
+  write(0x1c,profile.threshold,LidarLiteI2cAddress);
+  write(0x45,profile.interval,LidarLiteI2cAddress);
+  profileReadCount = 0;
+}
+
 /* =============================================================================
 
   Begin Continuous
@@ -236,6 +290,134 @@ int LIDARLite::distance(bool stablizePreampFlag, bool takeReference, char LidarL
   return(distance);
 }
 
+/* =============================================================================
+
+  Distance with a Profile
+
+  Same as distance() above, but the profile decides which readings get DC
+  stabilization: 1 out of every stabilizeEvery, starting with the first reading
+  after configure(). The same flag is passed as takeReference, which distance()
+  ignores, so there is no separate reference pulse control.
+
+============================================================================= */
+int LIDARLite::distance(const LIDARLiteProfile &profile, char LidarLiteI2cAddress){
+  bool stablizePreampFlag = profile.stabilizeEvery <= 1 || profileReadCount % profile.stabilizeEvery == 0;
+  profileReadCount++;
+  return distance(stablizePreampFlag, stablizePreampFlag, LidarLiteI2cAddress);
+}
+
+/* =============================================================================
+
+  Tune
+
+  Finds the fastest profile that is quiet enough. Point the sensor at a still
+  target at the distance you care about, then for each profile:
+
+  Process
+  ------------------------------------------------------------------------------
+  1.  Apply the profile with configure()
+  2.  Take numberOfReadings readings as fast as possible, timing them
+  3.  Count a reading as a dropout if the read bailed out or came back as 0
+  4.  From the good readings work out
+      - hz: good readings per second, so dropouts cost speed
+      - noise: standard deviation in cm
+      - dropoutRate: dropouts / numberOfReadings
+
+  The fastest profile with noise at or under noiseBudget (and at least two good
+  readings) wins and is left applied to the sensor. If none qualifies the
+  acquisition count, threshold and interval registers are put back to what
+  they were before tune() started.
+
+  Readings are single measurements, like distance(), so the interval of each
+  profile (register 0x45, continuous mode only) has no effect on the results.
+  Profiles that differ only in interval measure the same.
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - profiles: array of profiles to try
+  - numberOfProfiles: length of profiles
+  - noiseBudget: largest acceptable standard deviation in cm
+  - results (optional): array of numberOfProfiles to receive the measurements
+    for each profile, default is 0 (not reported)
+  - numberOfReadings (optional): readings per profile, default is 100
+  - LidarLiteI2cAddress (optional): Default: 0x62, the default LIDAR-Lite
+    address. If you change the address, fill it in here.
+
+  Returns the index of the chosen profile, or -1 if none met the budget.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Pick the fastest of three profiles that stays within 2cm
+      LIDARLiteProfile profiles[] = {
+        {0x80, 0x00, 1, 0xc8},
+        {0x40, 0x00, 10, 0xc8},
+        {0x20, 0x00, 100, 0xc8}
+      };
+      int chosen = myLidarLiteInstance.tune(profiles, 3, 2.0);
+
+============================================================================= */
+int LIDARLite::tune(const LIDARLiteProfile *profiles, int numberOfProfiles, float noiseBudget, LIDARLiteTuneResult *results, int numberOfReadings, char LidarLiteI2cAddress){
+  int bestProfile = -1;
+  float bestHz = 0;
+  //  Save acquisition count, threshold and interval to restore if no profile
+  //  meets the budget
+  byte savedCount[1];
+  byte savedThreshold[1];
+  byte savedInterval[1];
+  bool saved = read(0x02,1,savedCount,false,LidarLiteI2cAddress) &&
+               read(0x1c,1,savedThreshold,false,LidarLiteI2cAddress) &&
+               read(0x45,1,savedInterval,false,LidarLiteI2cAddress);
+  for(int p = 0; p < numberOfProfiles; p++){
+    configure(profiles[p], LidarLiteI2cAddress);
+    int goodReadings = 0;
+    int dropouts = 0;
+    //  Running mean and sum of squared differences (Welford), so no readings
+    //  need to be stored
+    float mean = 0;
+    float sumOfSquares = 0;
+    unsigned long start = micros();
+    for(int i = 0; i < numberOfReadings; i++){
+      bool stablizePreampFlag = profiles[p].stabilizeEvery <= 1 || i % profiles[p].stabilizeEvery == 0;
+      write(0x00,stablizePreampFlag ? 0x04 : 0x03,LidarLiteI2cAddress);
+      byte distanceArray[2];
+      if(!read(0x8f,2,distanceArray,true,LidarLiteI2cAddress)){
+        dropouts++;
+        continue;
+      }
+      int distance = (distanceArray[0] << 8) + distanceArray[1];
+      if(distance <= 0){
+        dropouts++;
+        continue;
+      }
+      goodReadings++;
+      float delta = distance - mean;
+      mean += delta / goodReadings;
+      sumOfSquares += delta * (distance - mean);
+    }
+    unsigned long elapsed = (uint32_t)(micros() - start);
+
+    float hz = elapsed > 0 ? goodReadings * 1000000.0 / elapsed : 0;
+    float noise = goodReadings > 1 ? sqrt(sumOfSquares / (goodReadings - 1)) : -1;
+    if(results){
+      results[p].hz = hz;
+      results[p].noise = noise;
+      results[p].dropoutRate = numberOfReadings > 0 ? (float)dropouts / numberOfReadings : 1;
+    }
+    if(goodReadings > 1 && noise <= noiseBudget && (bestProfile < 0 || hz > bestHz)){
+      bestProfile = p;
+      bestHz = hz;
+    }
+  }
+  if(bestProfile >= 0){
+    configure(profiles[bestProfile], LidarLiteI2cAddress);
+  }else if(saved){
+    write(0x02,savedCount[0],LidarLiteI2cAddress);
+    write(0x1c,savedThreshold[0],LidarLiteI2cAddress);
+    write(0x45,savedInterval[0],LidarLiteI2cAddress);
+  }
+  return bestProfile;
+}
+
 /* =============================================================================
 
   Distance Continuous
@@ -473,6 +655,10 @@ void LIDARLite::correlationRecordToArray(int *arrayToSave, int numberOfReadings,
     }
     // Send null command to control register
     write(0x40,0x00,LidarLiteI2cAddress);
+    // Test mode is now off, the next stream has to select it again
+    if(correlationStreamAddress == LidarLiteI2cAddress){
+      correlationStreamAddress = 0x00;
+    }
   }
 
 void LIDARLite::correlationRecordToSerial(char separator, int numberOfReadings, char LidarLiteI2cAddress){
@@ -499,6 +685,161 @@ void LIDARLite::correlationRecordToSerial(char separator, int numberOfReadings,
   }
   // Send null command to control register
   write(0x40,0x00,LidarLiteI2cAddress);
+  // Test mode is now off, the next stream has to select it again
+  if(correlationStreamAddress == LidarLiteI2cAddress){
+    correlationStreamAddress = 0x00;
+  }
+}
+
+/* =============================================================================
+  Correlation Record Stream
+
+  Streams the correlation record through two small caller-owned buffers instead
+  of one array the size of the whole record, so the memory used stays the same
+  however many samples or records are read. Buffers are filled in turn and each
+  full one is handed to the callback. A buffer is left untouched until the
+  callback for the next buffer has returned, so the callback may hold on to
+  the buffer it was given (ex. for a transfer that finishes later) until it is
+  called again.
+
+  The call still blocks until the whole record has been read, the callback runs
+  in between reads, not alongside them.
+
+  Test mode is left selected after the record, so consecutive records (with a
+  distance() in between) skip the setup. Call correlationRecordStreamEnd() when
+  done streaming.
+
+  Process
+  ------------------------------------------------------------------------------
+  1.  Take a distance reading (there is no correlation record without at least
+      one distance reading being taken)
+  2.  If test mode is not already selected on this sensor, set test mode select
+      by writing 0x07 to register 0x40
+  3.  Select memory bank by writing 0xc0 to register 0x5d, this starts reading
+      from the beginning of the record
+  4.  For as many readings as you want to take (max is 1024)
+      1.  Read two bytes from 0xd2, the low byte is the value and the high
+          byte the sign
+      2.  Store the value in the current buffer
+      3.  When the buffer is full hand it to the callback and switch buffers
+  5.  Hand any partly filled buffer to the callback
+
+  If a read fails the samples read so far are handed to the callback and the
+  record stops there.
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - firstBuffer: buffer of bufferLength samples
+  - secondBuffer: buffer of bufferLength samples. Pass 0 to use firstBuffer
+    only, then it is reused as soon as the callback returns.
+  - bufferLength: number of samples in each buffer
+  - callback: function called with each filled buffer, the number of samples
+    in it and the index of its first sample in the record
+  - numberOfReadings (optional): default is 256, max is 1024
+  - LidarLiteI2cAddress (optional): Default: 0x62, the default LIDAR-Lite
+    address. If you change the address, fill it in here.
+
+  Returns true if every sample was read, false if a read failed or callback is
+  null.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Print the record 16 samples at a time using 64 bytes of buffers
+      int16_t firstBuffer[16];
+      int16_t secondBuffer[16];
+
+      void printSamples(int16_t *samples, int numberOfSamples, int firstSample){
+        for(int i = 0; i < numberOfSamples; i++){
+          Serial.println(samples[i]);
+        }
+      }
+
+      myLidarLiteInstance.distance();
+      myLidarLiteInstance.correlationRecordStream(firstBuffer,secondBuffer,16,printSamples);
+
+  =========================================================================== */
+bool LIDARLite::correlationRecordStream(int16_t *firstBuffer, int16_t *secondBuffer, int bufferLength, LIDARLiteCorrelationCallback callback, int numberOfReadings, char LidarLiteI2cAddress){
+  if(bufferLength <= 0 || !callback){
+    return false;
+  }
+  // Set test mode select, unless it is still set from the last record
+  if(correlationStreamAddress != LidarLiteI2cAddress){
+    correlationRecordStreamEnd();
+    write(0x40,0x07,LidarLiteI2cAddress);
+    correlationStreamAddress = LidarLiteI2cAddress;
+  }
+  //  Selects memory bank
+  write(0x5d,0xc0,LidarLiteI2cAddress);
+
+  // Array to store read values
+  byte correlationArray[2];
+  int16_t *buffer = firstBuffer;
+  int filled = 0;
+  for(int i = 0; i < numberOfReadings; i++){
+    if(!read(0xd2,2,correlationArray,false,LidarLiteI2cAddress)){
+      if(filled > 0){
+        callback(buffer, filled, i - filled);
+      }
+      return false;
+    }
+    //  Low byte is the value of the correlation record
+    int16_t correlationValue = correlationArray[0];
+    // if upper byte lsb is set, the value is negative
+    if(correlationArray[1] == 1){
+      correlationValue |= 0xff00;
+    }
+    buffer[filled++] = correlationValue;
+    if(filled == bufferLength){
+      callback(buffer, filled, i + 1 - filled);
+      filled = 0;
+      if(secondBuffer){
+        buffer = (buffer == firstBuffer) ? secondBuffer : firstBuffer;
+      }
+    }
+  }
+  if(filled > 0){
+    callback(buffer, filled, numberOfReadings - filled);
+  }
+  return true;
+}
+
+/* =============================================================================
+  Correlation Record Stream End
+
+  Sends the null command to the control register to leave the test mode
+  selected by correlationRecordStream()
+
+  Test mode is also lost whenever the sensor resets, so begin(), a reset
+  through write() (0x00 to register 0x00, ex. configure(0)) and changeAddress()
+  all forget it, and the next stream selects it again.
+
+  =========================================================================== */
+void LIDARLite::correlationRecordStreamEnd(){
+  if(correlationStreamAddress == 0x00){
+    return;
+  }
+  // Send null command to control register
+  write(0x40,0x00,correlationStreamAddress);
+  correlationStreamAddress = 0x00;
+}
+
+/* =============================================================================
+  Correlation Record Stream Forget
+
+  Forgets that test mode is selected on one sensor without touching the bus,
+  for when the sensor was reset or powered off behind the library's back (ex.
+  through its PWR_EN pin). The next stream from it selects test mode again.
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - LidarLiteI2cAddress (optional): Default: 0x62, the default LIDAR-Lite
+    address. If you change the address, fill it in here.
+
+  =========================================================================== */
+void LIDARLite::correlationRecordStreamForget(char LidarLiteI2cAddress){
+  if(correlationStreamAddress == LidarLiteI2cAddress){
+    correlationStreamAddress = 0x00;
+  }
 }
 
 /* =============================================================================
@@ -550,6 +891,7 @@ void LIDARLite::correlationRecordToSerial(char separator, int numberOfReadings,
     8-bit read address for LIDAR-Lite is 0xc4 = 011000100. Essentially any hex
     value evenly divisable by "4" will work.
 
+    Returns the new address, or 0x00 if the sensor never reported it back.
 
   =========================================================================== */
 unsigned char LIDARLite::changeAddress(char newI2cAddress,  bool disablePrimaryAddress, char currentLidarLiteAddress){
@@ -565,10 +907,20 @@ unsigned char LIDARLite::changeAddress(char newI2cAddress,  bool disablePrimaryA
   write(0x19,serialNumber[1],currentLidarLiteAddress);
   //  Write the new address to 0x1a
   write(0x1a,newI2cAddress,currentLidarLiteAddress);
+  //  The sensor moves (or was just powered up), set test mode up again
+  correlationStreamAddress = 0x00;
 
 
+  //  Wait for the sensor to echo the new address back, give up rather than
+  //  hang if it never does (ex. it lost power part way through)
+  newI2cAddressArray[0] = 0x00;
+  int readbackCounter = 0;
   while(newI2cAddress != newI2cAddressArray[0]){
     read(0x1a,1,newI2cAddressArray,false,currentLidarLiteAddress);
+    readbackCounter++;
+    if(readbackCounter > 99){
+      return 0x00;
+    }
   }
   Serial.print("WIN!");
   //  Choose whether or not to use the default address of 0x62
@@ -648,12 +1000,21 @@ unsigned char LIDARLite::changeAddress(char newI2cAddress,  bool disablePrimaryA
     Wire.write((int)myValue);
     int nackCatcher = Wire.endTransmission();
     if(nackCatcher != 0){Serial.println("> nack");}
+    //  0x00 to register 0x00 resets the sensor, which leaves test mode (0x62
+    //  may be the party line, so it can reset the streaming sensor too)
+    if(myAddress == 0x00 && myValue == 0x00 && (LidarLiteI2cAddress == correlationStreamAddress || LidarLiteI2cAddress == 0x62)){
+      correlationStreamAddress = 0x00;
+    }
     delay(1);
   }
 
 /* =============================================================================
+  Read from LIDAR-Lite
+
+  Returns true if all of the requested bytes were read, false if the busy flag
+  never cleared (bailout) or the sensor did not answer.
   =========================================================================== */
-void LIDARLite::read(char myAddress, int numOfBytes, byte arrayToSave[2], bool monitorBusyFlag, char LidarLiteI2cAddress){
+bool LIDARLite::read(char myAddress, int numOfBytes, byte arrayToSave[2], bool monitorBusyFlag, char LidarLiteI2cAddress){
   int busyFlag = 0;
   if(monitorBusyFlag){
     busyFlag = 1;
@@ -712,11 +1073,14 @@ void LIDARLite::read(char myAddress, int numOfBytes, byte arrayToSave[2], bool m
         arrayToSave[i] = Wire.read();
         i++;
       }
+      return true;
     }
+    return false;
   }
   if(busyCounter > 9999){
     bailout:
       busyCounter = 0;
       Serial.println("> Bailout");
   }
+  return false;
 }
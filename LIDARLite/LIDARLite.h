@@ -1,24 +1,61 @@
+#ifndef LIDARLite_h
+#define LIDARLite_h
+
 #include <Arduino.h>
 
+//  Acquisition settings applied by configure(const LIDARLiteProfile &), see
+//  LIDARLite.cpp for what each register does. stabilizeEvery only picks DC
+//  stabilization (0x04) or not (0x03), there is no reference pulse control, and
+//  interval only matters in continuous mode (tune() does not measure it)
+struct LIDARLiteProfile
+{
+  unsigned char acquisitionCount;
+  unsigned char threshold;
+  unsigned char stabilizeEvery;
+  unsigned char interval;
+};
+
+//  What tune() measured for one profile
+struct LIDARLiteTuneResult
+{
+  float hz;
+  float noise;
+  float dropoutRate;
+};
+
+//  Called by correlationRecordStream() with each filled buffer, the number of
+//  samples in it and the index of its first sample in the record
+typedef void (*LIDARLiteCorrelationCallback)(int16_t *, int, int);
+
 class LIDARLite
 {
   public:
       LIDARLite();
       void begin(int = 0, bool = false, bool = false, char = 0x62);
       void configure(int = 0, char = 0x62);
+      void configure(const LIDARLiteProfile &, char = 0x62);
       void beginContinuous(bool = true, char = 0x04, char = 0xff, char = 0x62);
       void fast(char = 0x62);
       int distance(bool = true, bool = true, char = 0x62);
+      int distance(const LIDARLiteProfile &, char = 0x62);
+      int tune(const LIDARLiteProfile *, int, float, LIDARLiteTuneResult * = 0, int = 100, char = 0x62);
       int distanceContinuous(char = 0x62);
       void scale(char, char = 0x62);
       int velocity(char = 0x62);
       int signalStrength(char = 0x62);
       void correlationRecordToArray(int*,int = 256, char = 0x62);
       void correlationRecordToSerial(char = '\n', int = 256, char = 0x62);
+      bool correlationRecordStream(int16_t *, int16_t *, int, LIDARLiteCorrelationCallback, int = 256, char = 0x62);
+      void correlationRecordStreamEnd();
+      void correlationRecordStreamForget(char = 0x62);
       unsigned char changeAddress(char, bool = false, char = 0x62);
       void changeAddressMultiPwrEn(int , int* , unsigned char* , bool = false);
       void write(char, char, char = 0x62);
-      void read(char, int, byte*, bool, char);
+      bool read(char, int, byte*, bool, char);
   private:
       static bool errorReporting;
+      unsigned int profileReadCount;
+      char correlationStreamAddress;
 };
+
+#endif
@@ -0,0 +1,355 @@
+/* =============================================================================
+  LIDARLite Arduino Library: Sensor health monitor
+
+  When a sensor stops answering or hangs with its busy flag set, read() polls
+  the busy flag 9999 times before it bails out, and it does that again on every
+  call. In a multi-sensor loop a single hung unit stalls every other sensor.
+  Address changes are also lost on power off, so a sensor that browns out comes
+  back at 0x62 and never answers at the address the sketch expects.
+
+  LIDARLiteHealth sits between the sketch and LIDARLite and keeps a little
+  state per sensor:
+
+  1.  Distance reads poll the busy flag for at most readTimeout ms instead of
+      9999 times, so a failed read costs a bounded amount of time.
+  2.  Every failed distance read is counted. After maxFailures in a row the
+      sensor is quarantined and distance() returns -1 for it straight away,
+      without touching the bus, so the healthy sensors keep their rate.
+  3.  service() retries one quarantined sensor at a time, retryInterval ms
+      after it was quarantined. It resets the sensor (0x00 to register 0x00),
+      power cycles it through its PWR_EN pin if that isn't enough, then
+      re-applies the cached I2C address and configuration. A sensor only
+      leaves quarantine once a test measurement completes.
+  4.  Read, failure and recovery counts plus the time the last recovery took
+      are kept for each sensor.
+
+  Visit http://pulsedlight3d.com for documentation and support requests
+
+============================================================================= */
+
+#include <Arduino.h>
+#include "LIDARLite.h"
+#include "LIDARLiteHealth.h"
+
+LIDARLiteHealth::LIDARLiteHealth(LIDARLite &lidarLiteInstance) : lidarLite(lidarLiteInstance){
+  numOfSensors = 0;
+  maxFailures = 2;
+  retryInterval = 1000;
+  readTimeout = 20;
+}
+
+/* =============================================================================
+
+  Add Sensor
+
+  Registers a sensor with the monitor. The address and configuration are cached
+  so they can be re-applied after a reset or power loss.
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - LidarLiteI2cAddress: the address the sensor should answer on
+  - pwrEnPin (optional): digital pin connected to the sensor's PWR_EN line,
+    default is -1 (no power control, recovery is by reset only)
+  - configuration (optional): passed to LIDARLite::configure() after every
+    recovery, default is 0
+
+  Returns the index used by the other functions, or -1 if the monitor is full.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Three sensors wired as in the Multi-sensor PWR_EN diagram
+      int frontLidar = myLidarLiteHealth.addSensor(0x66,2);
+      int leftLidar = myLidarLiteHealth.addSensor(0x68,3);
+      int rightLidar = myLidarLiteHealth.addSensor(0x64,4);
+
+============================================================================= */
+int LIDARLiteHealth::addSensor(char LidarLiteI2cAddress, int pwrEnPin, int configuration){
+  if(numOfSensors >= LIDARLITE_HEALTH_MAX_SENSORS){
+    return -1;
+  }
+  Sensor &sensor = sensors[numOfSensors];
+  sensor.address = LidarLiteI2cAddress;
+  sensor.pwrEnPin = pwrEnPin;
+  sensor.configuration = configuration;
+  sensor.quarantined = false;
+  sensor.consecutiveFailures = 0;
+  sensor.nextRecoveryAttempt = 0;
+  sensor.reads = 0;
+  sensor.failures = 0;
+  sensor.recoveries = 0;
+  sensor.lastRecoveryTime = 0;
+  return numOfSensors++;
+}
+
+/* =============================================================================
+
+  Begin
+
+  Brings every registered sensor up with its cached address and configuration,
+  the same way changeAddressMultiPwrEn() does.
+
+  Process
+  ------------------------------------------------------------------------------
+  1.  Hold every sensor with a PWR_EN pin off
+  2.  One at a time, power the sensor on (it starts at 0x62) and move it to its
+      address with the party line disabled
+  3.  Write the cached configuration
+
+  Any sensor that does not come up is quarantined and left to service().
+
+============================================================================= */
+void LIDARLiteHealth::begin(){
+  for(int i = 0; i < numOfSensors; i++){
+    if(sensors[i].pwrEnPin >= 0){
+      pinMode(sensors[i].pwrEnPin, OUTPUT);
+      digitalWrite(sensors[i].pwrEnPin, LOW);
+    }
+  }
+  for(int i = 0; i < numOfSensors; i++){
+    Sensor &sensor = sensors[i];
+    if(sensor.pwrEnPin >= 0){
+      powerCycle(sensor.pwrEnPin);
+      lidarLite.correlationRecordStreamForget(sensor.address);
+      if(sensor.address != 0x62){
+        lidarLite.changeAddress(sensor.address, true, 0x62);
+      }
+    }
+    int distance;
+    if(!measure(sensor.address, true, &distance)){
+      quarantine(i);
+      continue;
+    }
+    if(sensor.configuration != 0){
+      lidarLite.configure(sensor.configuration, sensor.address);
+    }
+  }
+}
+
+/* =============================================================================
+
+  Distance
+
+  Takes a distance reading from one sensor, see LIDARLite::distance()
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - sensorIndex: the index returned by addSensor()
+  - stablizePreampFlag (optional): Default: true, take aquisition with DC
+    stabilization/correction
+
+  Returns the distance in cm, or -1 if the read failed or the sensor is
+  quarantined. A failed read costs at most readTimeout ms, a quarantined sensor
+  costs no bus time.
+
+============================================================================= */
+int LIDARLiteHealth::distance(int sensorIndex, bool stablizePreampFlag){
+  if(sensorIndex < 0 || sensorIndex >= numOfSensors){
+    return -1;
+  }
+  Sensor &sensor = sensors[sensorIndex];
+  if(sensor.quarantined){
+    return -1;
+  }
+  sensor.reads++;
+  int distance;
+  if(measure(sensor.address, stablizePreampFlag, &distance)){
+    sensor.consecutiveFailures = 0;
+    return distance;
+  }
+  sensor.failures++;
+  sensor.consecutiveFailures++;
+  if(sensor.consecutiveFailures >= maxFailures){
+    quarantine(sensorIndex);
+  }
+  return -1;
+}
+
+/* =============================================================================
+
+  Service
+
+  Call once per loop. Attempts recovery of at most one quarantined sensor whose
+  retry time has come, so the time spent here stays bounded.
+
+  Returns true if a sensor was recovered.
+
+============================================================================= */
+bool LIDARLiteHealth::service(){
+  unsigned long now = millis();
+  for(int i = 0; i < numOfSensors; i++){
+    //  Signed difference so the comparison survives millis() rolling over
+    if(sensors[i].quarantined && (long)(now - sensors[i].nextRecoveryAttempt) >= 0){
+      return recover(i);
+    }
+  }
+  return false;
+}
+
+/* =============================================================================
+
+  Recover
+
+  Tries to bring one sensor back
+
+  Process
+  ------------------------------------------------------------------------------
+  1.  Reset the sensor by writing 0x00 to register 0x00, then take a test
+      measurement
+  2.  If the measurement fails and the sensor has a PWR_EN pin, power cycle it
+  3.  If it now answers on 0x62 instead of its own address (the address was
+      lost), move it back to its address with the party line disabled
+  4.  Take another test measurement
+  5.  Re-apply the cached configuration and leave quarantine
+
+  A sensor that acknowledges I2C but keeps its busy flag set fails the test
+  measurement and stays quarantined. The next attempt is made retryInterval ms
+  later.
+
+  Notes
+  ------------------------------------------------------------------------------
+    Step 3 talks to 0x62, so the other sensors on the bus must have the party
+    line disabled (usePartyLine = false in changeAddressMultiPwrEn()).
+
+============================================================================= */
+bool LIDARLiteHealth::recover(int sensorIndex){
+  if(sensorIndex < 0 || sensorIndex >= numOfSensors){
+    return false;
+  }
+  Sensor &sensor = sensors[sensorIndex];
+  unsigned long recoveryStart = millis();
+
+  int distance;
+  lidarLite.write(0x00,0x00,sensor.address);
+  delay(20);
+  bool working = measure(sensor.address, true, &distance);
+  if(!working){
+    if(sensor.pwrEnPin >= 0){
+      powerCycle(sensor.pwrEnPin);
+      //  It comes back out of test mode
+      lidarLite.correlationRecordStreamForget(sensor.address);
+    }
+    if(sensor.address != 0x62 && !answers(sensor.address) && answers(0x62)){
+      lidarLite.changeAddress(sensor.address, true, 0x62);
+    }
+    working = measure(sensor.address, true, &distance);
+  }
+  if(!working){
+    sensor.nextRecoveryAttempt = millis() + retryInterval;
+    return false;
+  }
+  if(sensor.configuration != 0){
+    lidarLite.configure(sensor.configuration, sensor.address);
+  }
+  sensor.quarantined = false;
+  sensor.consecutiveFailures = 0;
+  sensor.recoveries++;
+  sensor.lastRecoveryTime = millis() - recoveryStart;
+  return true;
+}
+
+/* =============================================================================
+
+  Settings
+
+  - setMaxFailures: consecutive failed reads before a sensor is quarantined,
+    default is 2
+  - setRetryInterval: ms from quarantine to the first recovery attempt, and
+    between attempts on a sensor that stays down, default is 1000
+  - setReadTimeout: ms a distance read waits for the busy flag to clear before
+    it counts as a failure, default is 20
+
+============================================================================= */
+void LIDARLiteHealth::setMaxFailures(unsigned char failures){
+  maxFailures = failures > 0 ? failures : 1;
+}
+
+void LIDARLiteHealth::setRetryInterval(unsigned long interval){
+  retryInterval = interval;
+}
+
+void LIDARLiteHealth::setReadTimeout(unsigned long timeout){
+  readTimeout = timeout;
+}
+
+/* =============================================================================
+
+  Statistics
+
+  - quarantined: true while the sensor is being skipped
+  - readCount: distance reads attempted, including failures
+  - failureCount: distance reads that failed
+  - recoveryCount: successful recoveries
+  - recoveryTime: ms the last successful recovery took
+
+============================================================================= */
+bool LIDARLiteHealth::quarantined(int sensorIndex){
+  return sensorIndex >= 0 && sensorIndex < numOfSensors && sensors[sensorIndex].quarantined;
+}
+
+unsigned long LIDARLiteHealth::readCount(int sensorIndex){
+  return (sensorIndex >= 0 && sensorIndex < numOfSensors) ? sensors[sensorIndex].reads : 0;
+}
+
+unsigned long LIDARLiteHealth::failureCount(int sensorIndex){
+  return (sensorIndex >= 0 && sensorIndex < numOfSensors) ? sensors[sensorIndex].failures : 0;
+}
+
+unsigned long LIDARLiteHealth::recoveryCount(int sensorIndex){
+  return (sensorIndex >= 0 && sensorIndex < numOfSensors) ? sensors[sensorIndex].recoveries : 0;
+}
+
+unsigned long LIDARLiteHealth::recoveryTime(int sensorIndex){
+  return (sensorIndex >= 0 && sensorIndex < numOfSensors) ? sensors[sensorIndex].lastRecoveryTime : 0;
+}
+
+/* =============================================================================
+
+  Measure takes one distance reading like LIDARLite::distance(), but polls the
+  busy flag (bit 0 of 0x01) itself and gives up after readTimeout ms. A sensor
+  that does not answer, or answers with the busy flag stuck, fails here.
+
+============================================================================= */
+bool LIDARLiteHealth::measure(char LidarLiteI2cAddress, bool stablizePreampFlag, int *distance){
+  if(stablizePreampFlag){
+    lidarLite.write(0x00,0x04,LidarLiteI2cAddress);
+  }else{
+    lidarLite.write(0x00,0x03,LidarLiteI2cAddress);
+  }
+  byte status[1];
+  unsigned long start = millis();
+  while(!lidarLite.read(0x01,1,status,false,LidarLiteI2cAddress) || bitRead(status[0],0)){
+    if(millis() - start >= readTimeout){
+      return false;
+    }
+  }
+  byte distanceArray[2];
+  if(!lidarLite.read(0x8f,2,distanceArray,false,LidarLiteI2cAddress)){
+    return false;
+  }
+  *distance = (distanceArray[0] << 8) + distanceArray[1];
+  return true;
+}
+
+/* =============================================================================
+
+  Answers is true if anything acknowledges the address, used only to find out
+  where a sensor is, never as a sign that it works.
+
+============================================================================= */
+bool LIDARLiteHealth::answers(char LidarLiteI2cAddress){
+  byte status[1];
+  return lidarLite.read(0x01,1,status,false,LidarLiteI2cAddress);
+}
+
+void LIDARLiteHealth::powerCycle(int pwrEnPin){
+  pinMode(pwrEnPin, OUTPUT);
+  digitalWrite(pwrEnPin, LOW);
+  delay(2);
+  digitalWrite(pwrEnPin, HIGH);
+  delay(20);
+}
+
+void LIDARLiteHealth::quarantine(int sensorIndex){
+  sensors[sensorIndex].quarantined = true;
+  sensors[sensorIndex].nextRecoveryAttempt = millis() + retryInterval;
+}
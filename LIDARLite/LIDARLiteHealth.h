@@ -0,0 +1,54 @@
+#ifndef LIDARLiteHealth_h
+#define LIDARLiteHealth_h
+
+#include <Arduino.h>
+#include "LIDARLite.h"
+
+//  Number of sensors a single monitor can track. Fixed by the library, it
+//  sizes the class's own members.
+#define LIDARLITE_HEALTH_MAX_SENSORS 8
+
+class LIDARLiteHealth
+{
+  public:
+      LIDARLiteHealth(LIDARLite &);
+      int addSensor(char, int = -1, int = 0);
+      void begin();
+      int distance(int, bool = true);
+      bool service();
+      bool recover(int);
+      void setMaxFailures(unsigned char);
+      void setRetryInterval(unsigned long);
+      void setReadTimeout(unsigned long);
+      bool quarantined(int);
+      unsigned long readCount(int);
+      unsigned long failureCount(int);
+      unsigned long recoveryCount(int);
+      unsigned long recoveryTime(int);
+  private:
+      struct Sensor
+      {
+        char address;
+        int pwrEnPin;
+        int configuration;
+        bool quarantined;
+        unsigned char consecutiveFailures;
+        unsigned long nextRecoveryAttempt;
+        unsigned long reads;
+        unsigned long failures;
+        unsigned long recoveries;
+        unsigned long lastRecoveryTime;
+      };
+      bool measure(char, bool, int *);
+      bool answers(char);
+      void powerCycle(int);
+      void quarantine(int);
+      LIDARLite &lidarLite;
+      Sensor sensors[LIDARLITE_HEALTH_MAX_SENSORS];
+      int numOfSensors;
+      unsigned char maxFailures;
+      unsigned long retryInterval;
+      unsigned long readTimeout;
+};
+
+#endif
@@ -0,0 +1,370 @@
+/* =============================================================================
+  LIDARLite Arduino Library: PWM capture
+
+  LIDAR-Lite reports every measurement on the MODE pin as a pulse whose width is
+  proportional to distance (10 microseconds per centimeter). The PWM example
+  used to time that pulse with pulseIn(), which blocks the whole sketch for up
+  to a full measurement period and can only watch one sensor at a time.
+
+  LIDARLitePWM times the pulse from a pin change interrupt instead. Each rising
+  edge stores a timestamp, each falling edge turns the elapsed time into a
+  pulse width and drops it into a small ring buffer. The sketch pulls distances
+  out of the buffer whenever it is ready, without ever waiting on the sensor.
+
+  Visit http://pulsedlight3d.com for documentation and support requests
+
+============================================================================= */
+
+#include <Arduino.h>
+#include "LIDARLite.h"
+#include "LIDARLitePWM.h"
+
+/* =============================================================================
+
+  Pulses longer than this are thrown away. LIDAR-Lite v2 tops out at 40m, or
+  40000us, so anything past that is a glitch or a missed edge.
+
+============================================================================= */
+#define LIDARLITE_PWM_MAX_PULSE 45000UL
+
+/* =============================================================================
+
+  attachInterrupt() only takes a plain function, so each capture slot gets its
+  own static trampoline that forwards the edge to the instance registered in
+  that slot.
+
+============================================================================= */
+LIDARLitePWM *LIDARLitePWM::instances[LIDARLITE_PWM_MAX_SENSORS];
+
+void LIDARLitePWM::isr0(){ instances[0]->service(); }
+void LIDARLitePWM::isr1(){ instances[1]->service(); }
+void LIDARLitePWM::isr2(){ instances[2]->service(); }
+void LIDARLitePWM::isr3(){ instances[3]->service(); }
+
+LIDARLitePWM::LIDARLitePWM(){
+  monitorPin = -1;
+  triggerPin = -1;
+  slot = -1;
+  widths = defaultWidths;
+  widthsMask = LIDARLITE_PWM_BUFFER_SIZE - 1;
+  pulseStarted = false;
+  riseTime = 0;
+  head = 0;
+  tail = 0;
+  overrunCount = 0;
+}
+
+/* =============================================================================
+
+  Begin
+
+  Starts capturing pulses from one sensor
+
+  Process
+  ------------------------------------------------------------------------------
+  1.  Make sure no other instance is capturing the same pin and find a free
+      capture slot
+  2.  Pull the trigger pin low so the sensor measures continuously
+  3.  Attach a CHANGE interrupt to the monitor pin
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - monitorPin: pin connected to the sensor's MODE line, this must be a pin
+    that supports attachInterrupt() (pins 2 and 3 on the Uno)
+  - triggerPin (optional): pin connected to the MODE line through the 1k
+    resistor shown in the PWM wiring diagram. Default: -1, leave the trigger
+    alone (tie it low in hardware)
+
+  Returns false if the pin has no interrupt, another instance is already
+  capturing it or all capture slots are in use. A capture that is already
+  running on this instance is left alone when begin() fails.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Monitor on pin 3, trigger on pin 2, same as the PWM wiring diagram
+      LIDARLitePWM myLidarLitePWM;
+      myLidarLitePWM.begin(3,2);
+
+============================================================================= */
+bool LIDARLitePWM::begin(int monitorPinNumber, int triggerPinNumber){
+  int interruptNumber = digitalPinToInterrupt(monitorPinNumber);
+  if(interruptNumber < 0){
+    return false;
+  }
+  //  A second attachInterrupt() on the pin would silently replace the first
+  //  instance's handler
+  int freeSlot = slot;
+  for(int i = 0; i < LIDARLITE_PWM_MAX_SENSORS; i++){
+    if(instances[i] == 0 || instances[i] == this){
+      if(freeSlot < 0){
+        freeSlot = i;
+      }
+    }else if(instances[i]->monitorPin == monitorPinNumber){
+      return false;
+    }
+  }
+  if(freeSlot < 0){
+    return false;
+  }
+  end();
+  slot = freeSlot;
+  monitorPin = monitorPinNumber;
+  triggerPin = triggerPinNumber;
+  clear();
+  if(triggerPin >= 0){
+    pinMode(triggerPin, OUTPUT);
+    digitalWrite(triggerPin, LOW); // Set trigger LOW for continuous read
+  }
+  pinMode(monitorPin, INPUT);
+  instances[slot] = this;
+  void (*handlers[])() = {isr0, isr1, isr2, isr3};
+  attachInterrupt(interruptNumber, handlers[slot], CHANGE);
+  return true;
+}
+
+/* =============================================================================
+
+  Begin with I2C configuration
+
+  LIDAR-Lite keeps reporting on the MODE pin while I2C is active, so the sensor
+  can be set up over I2C (acquisition count, threshold, etc.) and then read
+  over PWM without the I2C bus being touched again.
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - lidarLite: a LIDARLite instance that has already called begin()
+  - configuration: passed through to LIDARLite::configure()
+  - monitorPin, triggerPin: see begin() above
+  - LidarLiteI2cAddress (optional): Default: 0x62, the default LIDAR-Lite
+    address. If you change the address, fill it in here.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Use the high speed configuration and read it over PWM
+      myLidarLite.begin();
+      myLidarLitePWM.begin(myLidarLite,1,3,2);
+
+============================================================================= */
+bool LIDARLitePWM::begin(LIDARLite &lidarLite, int configuration, int monitorPinNumber, int triggerPinNumber, char LidarLiteI2cAddress){
+  lidarLite.configure(configuration, LidarLiteI2cAddress);
+  return begin(monitorPinNumber, triggerPinNumber);
+}
+
+/* =============================================================================
+
+  End
+
+  Detaches the interrupt and frees the capture slot
+
+============================================================================= */
+void LIDARLitePWM::end(){
+  if(slot < 0){
+    return;
+  }
+  detachInterrupt(digitalPinToInterrupt(monitorPin));
+  instances[slot] = 0;
+  slot = -1;
+}
+
+/* =============================================================================
+
+  Set Buffer
+
+  Replaces the built in 8 reading buffer with storage owned by the sketch, for
+  when more readings have to be kept between calls. Empties the buffer.
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - buffer: array of bufferLength pulse widths, it must stay valid for as long
+    as this instance captures (declare it global or static)
+  - bufferLength: a power of two no larger than 128 (the head and tail
+    counters are a byte wide)
+
+  Returns false, and keeps the current buffer, if bufferLength is not a power
+  of two no larger than 128.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Keep the last 32 readings
+      volatile unsigned int widths[32];
+      myLidarLitePWM.setBuffer(widths,32);
+      myLidarLitePWM.begin(3,2);
+
+============================================================================= */
+bool LIDARLitePWM::setBuffer(volatile unsigned int *buffer, int bufferLength){
+  if(buffer == 0 || bufferLength < 1 || bufferLength > 128 || (bufferLength & (bufferLength - 1)) != 0){
+    return false;
+  }
+  noInterrupts();
+  widths = buffer;
+  widthsMask = bufferLength - 1;
+  interrupts();
+  clear();
+  return true;
+}
+
+/* =============================================================================
+
+  Available
+
+  Returns how many distances are waiting in the buffer
+
+============================================================================= */
+int LIDARLitePWM::available(){
+  noInterrupts();
+  unsigned char count = head - tail;
+  interrupts();
+  return count;
+}
+
+/* =============================================================================
+
+  Distance
+
+  Returns the oldest buffered distance in cm and removes it from the buffer, or
+  -1 if nothing has been captured since the last call.
+
+  Example Usage
+  ------------------------------------------------------------------------------
+  1.  //  Print every distance as it arrives
+      while(myLidarLitePWM.available()){
+        Serial.println(myLidarLitePWM.distance());
+      }
+
+============================================================================= */
+int LIDARLitePWM::distance(){
+  noInterrupts();
+  if(head == tail){
+    interrupts();
+    return -1;
+  }
+  unsigned int width = widths[tail & widthsMask];
+  tail++;
+  interrupts();
+  return pulseWidthToDistance(width);
+}
+
+/* =============================================================================
+
+  Distance Latest
+
+  Returns the newest buffered distance in cm and empties the buffer, or -1 if
+  nothing has been captured since the last call. Use this when only the current
+  distance matters and older readings can be dropped.
+
+============================================================================= */
+int LIDARLitePWM::distanceLatest(){
+  unsigned int width = pulseWidth();
+  if(width == 0){
+    return -1;
+  }
+  return pulseWidthToDistance(width);
+}
+
+/* =============================================================================
+
+  Pulse Width
+
+  Returns the newest raw pulse width in microseconds and empties the buffer, or
+  0 if nothing has been captured since the last call.
+
+============================================================================= */
+unsigned int LIDARLitePWM::pulseWidth(){
+  noInterrupts();
+  if(head == tail){
+    interrupts();
+    return 0;
+  }
+  unsigned int width = widths[(unsigned char)(head - 1) & widthsMask];
+  tail = head;
+  interrupts();
+  return width;
+}
+
+/* =============================================================================
+
+  Overruns
+
+  Number of pulses dropped because the buffer was full. The oldest reading is
+  the one dropped, so a sketch that falls behind still sees fresh distances.
+
+============================================================================= */
+unsigned long LIDARLitePWM::overruns(){
+  noInterrupts();
+  unsigned long count = overrunCount;
+  interrupts();
+  return count;
+}
+
+/* =============================================================================
+
+  Clear
+
+  Empties the buffer, resets the overrun count and waits for a fresh rising
+  edge before timing the next pulse
+
+============================================================================= */
+void LIDARLitePWM::clear(){
+  noInterrupts();
+  pulseStarted = false;
+  riseTime = 0;
+  head = 0;
+  tail = 0;
+  overrunCount = 0;
+  interrupts();
+}
+
+/* =============================================================================
+
+  Handle Edge
+
+  Core of the capture, called from the interrupt with the pin level and the
+  time of the edge. It does not touch any hardware, so it can also be fed by a
+  simulated pulse source.
+
+  Parameters
+  ------------------------------------------------------------------------------
+  - level: true for a rising edge (pin is now HIGH), false for a falling edge
+  - timestamp: time of the edge in microseconds, as returned by micros()
+
+============================================================================= */
+void LIDARLitePWM::handleEdge(bool level, unsigned long timestamp){
+  if(level){
+    riseTime = timestamp;
+    pulseStarted = true;
+    return;
+  }
+  if(!pulseStarted){
+    return;
+  }
+  pulseStarted = false;
+  //  Unsigned subtraction stays correct when micros() rolls over, kept to the
+  //  32 bits micros() counts in even where unsigned long is wider
+  unsigned long width = (uint32_t)(timestamp - riseTime);
+  if(width == 0 || width > LIDARLITE_PWM_MAX_PULSE){
+    return;
+  }
+  if((unsigned char)(head - tail) > widthsMask){
+    tail++;
+    overrunCount++;
+  }
+  widths[head & widthsMask] = (unsigned int)width;
+  head++;
+}
+
+/* =============================================================================
+
+  Pulse Width To Distance
+
+  10us = 1 cm of distance for LIDAR-Lite
+
+============================================================================= */
+int LIDARLitePWM::pulseWidthToDistance(unsigned long width){
+  return (int)(width / 10);
+}
+
+void LIDARLitePWM::service(){
+  //  Take the timestamp first, digitalRead() adds a few microseconds
+  unsigned long timestamp = micros();
+  handleEdge(digitalRead(monitorPin) == HIGH, timestamp);
+}
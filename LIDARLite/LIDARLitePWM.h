@@ -0,0 +1,52 @@
+#ifndef LIDARLitePWM_h
+#define LIDARLitePWM_h
+
+#include <Arduino.h>
+
+class LIDARLite;
+
+//  Number of sensors that can be sampled at the same time, one per interrupt
+//  capable pin. Fixed by the library, it sizes the class's own members.
+#define LIDARLITE_PWM_MAX_SENSORS 4
+
+//  Number of pulse widths buffered per sensor unless setBuffer() hands it
+//  bigger storage. Fixed by the library, it sizes the class's own members.
+#define LIDARLITE_PWM_BUFFER_SIZE 8
+
+class LIDARLitePWM
+{
+  public:
+      LIDARLitePWM();
+      bool begin(int, int = -1);
+      bool begin(LIDARLite &, int, int, int = -1, char = 0x62);
+      void end();
+      bool setBuffer(volatile unsigned int *, int);
+      int available();
+      int distance();
+      int distanceLatest();
+      unsigned int pulseWidth();
+      unsigned long overruns();
+      void clear();
+      void handleEdge(bool, unsigned long);
+      static int pulseWidthToDistance(unsigned long);
+  private:
+      void service();
+      static void isr0();
+      static void isr1();
+      static void isr2();
+      static void isr3();
+      static LIDARLitePWM *instances[LIDARLITE_PWM_MAX_SENSORS];
+      int monitorPin;
+      int triggerPin;
+      int slot;
+      volatile bool pulseStarted;
+      volatile unsigned long riseTime;
+      volatile unsigned int defaultWidths[LIDARLITE_PWM_BUFFER_SIZE];
+      volatile unsigned int *widths;
+      unsigned char widthsMask;
+      volatile unsigned char head;
+      volatile unsigned char tail;
+      volatile unsigned long overrunCount;
+};
+
+#endif
@@ -0,0 +1,63 @@
+/* =============================================================================
+  LIDAR-Lite v2: Keep multiple sensors running when one of them fails
+
+  This example demonstrates how to use LIDARLiteHealth with sensors wired as
+  in the Multi-sensor PWR_EN diagram. A sensor that stops answering is skipped
+  so the others keep their rate, and is brought back with a reset or a power
+  cycle and its address and configuration re-applied. Once a second the read
+  rate of each sensor and the time of its last recovery are printed, pull a
+  sensor's power or I2C wires to watch it recover.
+
+  The library is in BETA, so subscribe to the github repo to recieve updates, or
+  just check in periodically:
+  https://github.com/PulsedLight3D/LIDARLite_v2_Arduino_Library
+
+  To learn more read over lidarlite.cpp as each function is commented
+=========================================================================== */
+
+#include <Wire.h>
+#include <LIDARLite.h>
+#include <LIDARLiteHealth.h>
+
+LIDARLite myLidarLite;
+LIDARLiteHealth myLidarLiteHealth(myLidarLite);
+
+int sensorPins[] = {2,3,4}; // Array of pins connected to the sensor Power Enable lines
+unsigned char addresses[] = {0x66,0x68,0x64};
+unsigned long lastReadCount[3];
+unsigned long lastReport = 0;
+
+void setup() {
+  Serial.begin(115200);
+  myLidarLite.begin();
+  for(int i = 0; i < 3; i++){
+    myLidarLiteHealth.addSensor(addresses[i], sensorPins[i]);
+  }
+  myLidarLiteHealth.begin();
+}
+
+void loop() {
+  for(int i = 0; i < 3; i++){
+    myLidarLiteHealth.distance(i);
+  }
+  myLidarLiteHealth.service();
+
+  if(millis() - lastReport >= 1000){
+    lastReport = millis();
+    for(int i = 0; i < 3; i++){
+      unsigned long reads = myLidarLiteHealth.readCount(i);
+      Serial.print("Sensor 0x");
+      Serial.print(addresses[i], HEX);
+      Serial.print(myLidarLiteHealth.quarantined(i) ? " (down): " : ": ");
+      Serial.print(reads - lastReadCount[i]);
+      Serial.print(" reads/s, ");
+      Serial.print(myLidarLiteHealth.failureCount(i));
+      Serial.print(" failures, ");
+      Serial.print(myLidarLiteHealth.recoveryCount(i));
+      Serial.print(" recoveries, last took ");
+      Serial.print(myLidarLiteHealth.recoveryTime(i));
+      Serial.println("ms");
+      lastReadCount[i] = reads;
+    }
+  }
+}
@@ -0,0 +1,61 @@
+/* =============================================================================
+  LIDAR-Lite v2: Find the fastest acquisition profile within a noise budget
+
+  This example demonstrates how to use acquisition profiles and tune(). Point
+  the sensor at a still target at the distance you care about and reset the
+  Arduino. Each profile is tried for 100 readings and its rate, noise and
+  dropout rate are printed, then the fastest profile with a standard deviation
+  of 2cm or less is used to take distance measurements.
+
+  The library is in BETA, so subscribe to the github repo to recieve updates, or
+  just check in periodically:
+  https://github.com/PulsedLight3D/LIDARLite_v2_Arduino_Library
+
+  To learn more read over lidarlite.cpp as each function is commented
+=========================================================================== */
+
+#include <Wire.h>
+#include <LIDARLite.h>
+
+LIDARLite myLidarLite;
+
+//  {acquisitionCount, threshold, stabilizeEvery, interval}
+LIDARLiteProfile profiles[] = {
+  {0x80, 0x00, 1, 0xc8},   // Sensor defaults
+  {0x80, 0x20, 1, 0xc8},   // Low noise, low sensitivity threshold
+  {0x40, 0x00, 10, 0xc8},  // Half the acquisitions, stabilize 1 in 10
+  {0x20, 0x00, 100, 0xc8}, // Quarter the acquisitions, stabilize 1 in 100
+  {0x10, 0x60, 100, 0xc8}  // Fewest acquisitions, high sensitivity threshold
+};
+const int numberOfProfiles = 5;
+LIDARLiteTuneResult results[numberOfProfiles];
+int chosenProfile = -1;
+
+void setup() {
+  Serial.begin(115200);
+  myLidarLite.begin(0,true); // Reset the sensor and use 400kHz I2C
+
+  chosenProfile = myLidarLite.tune(profiles, numberOfProfiles, 2.0, results);
+
+  for(int i = 0; i < numberOfProfiles; i++){
+    Serial.print("Profile ");
+    Serial.print(i);
+    Serial.print(": ");
+    Serial.print(results[i].hz);
+    Serial.print(" Hz, noise ");
+    Serial.print(results[i].noise);
+    Serial.print(" cm, dropouts ");
+    Serial.print(results[i].dropoutRate * 100);
+    Serial.println("%");
+  }
+  Serial.print("Chosen profile: ");
+  Serial.println(chosenProfile);
+  if(chosenProfile < 0){
+    chosenProfile = 0;
+    myLidarLite.configure(profiles[chosenProfile]);
+  }
+}
+
+void loop() {
+  Serial.println(myLidarLite.distance(profiles[chosenProfile]));
+}
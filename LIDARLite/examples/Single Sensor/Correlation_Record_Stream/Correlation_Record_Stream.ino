@@ -0,0 +1,56 @@
+/* =============================================================================
+  LIDAR-Lite v2: Single Sensor, stream the correlation record
+
+  This example demonstrates how to capture correlation records continuously
+  with two small buffers instead of an array the size of the record. Each
+  buffer of 16 samples is summed as it arrives (swap in your own processing),
+  and after every record the buffer memory used and the samples per second
+  read from the sensor are printed.
+
+  The library is in BETA, so subscribe to the github repo to recieve updates, or
+  just check in periodically:
+  https://github.com/PulsedLight3D/LIDARLite_v2_Arduino_Library
+
+  To learn more read over lidarlite.cpp as each function is commented
+=========================================================================== */
+
+#include <Wire.h>
+#include <LIDARLite.h>
+
+#define SAMPLES_PER_BUFFER 16
+#define SAMPLES_PER_RECORD 256
+
+LIDARLite myLidarLite;
+int16_t firstBuffer[SAMPLES_PER_BUFFER];
+int16_t secondBuffer[SAMPLES_PER_BUFFER];
+long recordSum = 0;
+
+void processSamples(int16_t *samples, int numberOfSamples, int firstSample){
+  for(int i = 0; i < numberOfSamples; i++){
+    recordSum += samples[i];
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  myLidarLite.begin(0,true);
+  Serial.print("Buffer memory: ");
+  Serial.print(sizeof(firstBuffer) + sizeof(secondBuffer));
+  Serial.print(" bytes, a full record array would take ");
+  Serial.print(SAMPLES_PER_RECORD * sizeof(int));
+  Serial.println(" bytes");
+}
+
+void loop() {
+  myLidarLite.distance();
+  recordSum = 0;
+  unsigned long start = micros();
+  myLidarLite.correlationRecordStream(firstBuffer, secondBuffer, SAMPLES_PER_BUFFER, processSamples, SAMPLES_PER_RECORD);
+  unsigned long elapsed = micros() - start;
+
+  Serial.print("Record sum: ");
+  Serial.print(recordSum);
+  Serial.print(", ");
+  Serial.print(SAMPLES_PER_RECORD * 1000000.0 / elapsed);
+  Serial.println(" samples/s");
+}
@@ -2,7 +2,8 @@
   LIDAR-Lite v2: PWM operation
 
   This example demonstrates how to read measurements from LIDAR-Lite v2 "Blue
-  Label" using PWM
+  Label" using PWM. The pulse is timed from an interrupt, so loop() never waits
+  on the sensor.
 
   The library is in BETA, so subscribe to the github repo to recieve updates, or
   just check in periodically:
@@ -11,21 +12,21 @@
   To learn more read over lidarlite.cpp as each function is commented
 =========================================================================== */
 
-unsigned long pulse_width;
+#include <Wire.h>
+#include <LIDARLite.h>
+#include <LIDARLitePWM.h>
+
+LIDARLitePWM myLidarLitePWM;
 
 void setup()
 {
   Serial.begin(115200); // Start serial communications
-  pinMode(2, OUTPUT); // Set pin 2 as trigger pin
-  pinMode(3, INPUT); // Set pin 3 as monitor pin
-  digitalWrite(2, LOW); // Set trigger LOW for continuous read
+  myLidarLitePWM.begin(3, 2); // Pin 3 is the monitor pin, pin 2 is the trigger pin
 }
 
 void loop()
 {
-  pulse_width = pulseIn(3, HIGH); // Count how long the pulse is high in microseconds
-  if(pulse_width != 0){ // If we get a reading that isn't zero, let's print it
-        pulse_width = pulse_width/10; // 10usec = 1 cm of distance for LIDAR-Lite
-  	Serial.println(pulse_width); // Print the distance
+  while(myLidarLitePWM.available()){ // Print every distance captured since the last loop
+    Serial.println(myLidarLitePWM.distance());
   }
 }
@@ -2,7 +2,9 @@
   LIDAR-Lite v2: PWM and I2C operation
 
   This example file will demonstrate how to use PWM and I2C at the same
-  time, an exciting new feature of LIDAR-Lite
+  time, an exciting new feature of LIDAR-Lite. The sensor is configured over
+  I2C and the distance is read from the PWM pulse, leaving the I2C bus free for
+  other work (here, reading signal strength).
 
   The library is in BETA, so subscribe to the github repo to recieve updates, or
   just check in periodically:
@@ -10,12 +12,27 @@
 
   To learn more read over lidarlite.cpp as each function is commented
   =========================================================================== */
-void setup() {
-  // put your setup code here, to run once:
 
+#include <Wire.h>
+#include <LIDARLite.h>
+#include <LIDARLitePWM.h>
+
+LIDARLite myLidarLite;
+LIDARLitePWM myLidarLitePWM;
+
+void setup() {
+  Serial.begin(115200);
+  myLidarLite.begin();
+  //  Use the high speed configuration (1), monitor on pin 3, trigger on pin 2
+  myLidarLitePWM.begin(myLidarLite, 1, 3, 2);
 }
 
 void loop() {
-  // put your main code here, to run repeatedly:
-
+  int distance = myLidarLitePWM.distanceLatest();
+  if(distance >= 0){
+    Serial.print("Distance: ");
+    Serial.print(distance);
+    Serial.print(", Signal Strength: ");
+    Serial.println(myLidarLite.signalStrength());
+  }
 }
@@ -0,0 +1,28 @@
+#include "check.h"
+#include "Arduino.h"
+
+TestCase *testCases = 0;
+int testFailures = 0;
+
+int main(){
+  //  Registration prepends, so reverse to run in file order
+  TestCase *ordered = 0;
+  while(testCases){
+    TestCase *next = testCases->next;
+    testCases->next = ordered;
+    ordered = testCases;
+    testCases = next;
+  }
+  int failedTests = 0;
+  for(TestCase *testCase = ordered; testCase; testCase = testCase->next){
+    int failuresBefore = testFailures;
+    shim::reset();
+    printf("%s\n", testCase->name);
+    testCase->run();
+    if(testFailures != failuresBefore){
+      failedTests++;
+    }
+  }
+  printf("%d test(s) failed\n", failedTests);
+  return failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+/* =============================================================================
+  Minimal test harness: TEST() registers a function, CHECK() records a failure
+  and keeps going, main() runs every test and returns non-zero on failure.
+============================================================================= */
+#ifndef check_h
+#define check_h
+
+#include <stdio.h>
+
+struct TestCase
+{
+  const char *name;
+  void (*run)();
+  TestCase *next;
+};
+
+extern TestCase *testCases;
+extern int testFailures;
+
+struct TestRegistration
+{
+  TestRegistration(TestCase *testCase){
+    testCase->next = testCases;
+    testCases = testCase;
+  }
+};
+
+#define TEST(name) \
+  static void name(); \
+  static TestCase name##Case = {#name, name, 0}; \
+  static TestRegistration name##Registration(&name##Case); \
+  static void name()
+
+#define CHECK(condition) \
+  do{ \
+    if(!(condition)){ \
+      printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      testFailures++; \
+    } \
+  }while(0)
+
+#define CHECK_EQUAL(expected, actual) \
+  do{ \
+    long long expectedValue = (long long)(expected); \
+    long long actualValue = (long long)(actual); \
+    if(expectedValue != actualValue){ \
+      printf("  %s:%d: expected %s == %lld, got %lld\n", __FILE__, __LINE__, #actual, expectedValue, actualValue); \
+      testFailures++; \
+    } \
+  }while(0)
+
+#endif
@@ -0,0 +1,80 @@
+/* =============================================================================
+  Linux stand-in for the parts of the Arduino core the library uses, so the
+  library can be built and exercised on a desktop against a simulated bus.
+
+  Time only moves when the code under test calls delay()/delayMicroseconds(),
+  when an I2C transaction takes place (see Wire.h) or when a test calls
+  shim::advance(). micros() wraps at 32 bits like it does on the Arduino.
+============================================================================= */
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define ARDUINO 10800
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define DEC 10
+#define HEX 16
+#define NOT_AN_INTERRUPT -1
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+
+void pinMode(int, int);
+void digitalWrite(int, int);
+int digitalRead(int);
+
+int digitalPinToInterrupt(int);
+void attachInterrupt(int, void (*)(), int);
+void detachInterrupt(int);
+void noInterrupts();
+void interrupts();
+
+class HardwareSerial
+{
+  public:
+      void begin(unsigned long){}
+      template<typename T> void print(T, int = DEC){}
+      template<typename T> void println(T, int = DEC){}
+      void println(){}
+};
+
+extern HardwareSerial Serial;
+
+namespace shim
+{
+  //  Put time, pins and interrupts back to power-on state
+  void reset();
+  //  Move simulated time forward, firing nothing
+  void advance(unsigned long microseconds);
+  //  Set simulated time, micros() returns the low 32 bits of it
+  void setMicros(unsigned long long microseconds);
+  unsigned long long now();
+  //  Drive an input pin from outside, fires an attached interrupt on change
+  void setPin(int pin, int level);
+  //  Level last written to a pin with digitalWrite()
+  int outputLevel(int pin);
+  //  Called on every digitalWrite(), used by simulated devices on PWR_EN pins
+  void onDigitalWrite(void (*hook)(int pin, int level));
+  //  Input pulse of the given width in microseconds, starting now
+  void pulse(int pin, unsigned long width);
+}
+
+#endif
@@ -0,0 +1,206 @@
+#include "FakeLidarLite.h"
+
+#include <vector>
+
+namespace
+{
+  std::vector<FakeLidarLite *> &sensors(){
+    static std::vector<FakeLidarLite *> registered;
+    return registered;
+  }
+}
+
+FakeLidarLite::FakeLidarLite(int pwrEnPinNumber, unsigned int serial){
+  pwrEnPin = pwrEnPinNumber;
+  serialNumber = serial;
+  targetDistance = 200;
+  noise = 0;
+  dropoutBelowCount = 0;
+  dropoutRate = 0;
+  randomState = serial;
+  fault = NoFault;
+  faultClearedByReset = false;
+  faultSurvivesPowerCycle = false;
+  acquisitions = 0;
+  stabilizedAcquisitions = 0;
+  readsOutsideTestMode = 0;
+  correlationPointer = 0;
+  memset(registerWrites, 0, sizeof(registerWrites));
+  powered = false;
+  address = 0x62;
+  primaryDisabled = false;
+  registerPointer = 0;
+  busyUntil = 0;
+  distance = 0;
+  resetRegisters();
+  if(pwrEnPin < 0 || shim::outputLevel(pwrEnPin) == HIGH){
+    powerUp();
+  }
+  sensors().push_back(this);
+  shim::onDigitalWrite(pinChanged);
+}
+
+FakeLidarLite::~FakeLidarLite(){
+  std::vector<FakeLidarLite *> &registered = sensors();
+  for(size_t i = 0; i < registered.size(); i++){
+    if(registered[i] == this){
+      registered.erase(registered.begin() + i);
+      break;
+    }
+  }
+}
+
+bool FakeLidarLite::answers(int i2cAddress){
+  if(!powered || fault == NoAnswer){
+    return false;
+  }
+  return i2cAddress == address || (i2cAddress == 0x62 && !primaryDisabled);
+}
+
+void FakeLidarLite::receive(const byte *data, int length){
+  if(length < 1){
+    return;
+  }
+  registerPointer = data[0];
+  if(length < 2){
+    return;
+  }
+  byte reg = data[0] & 0x7f;
+  byte value = data[1];
+  registerWrites[reg]++;
+  switch(reg){
+    case 0x00:
+      if(value == 0x00){
+        resetRegisters();
+        if(faultClearedByReset){
+          fault = NoFault;
+        }
+      }else if(value == 0x03 || value == 0x04){
+        startAcquisition(value == 0x04);
+      }
+    break;
+    case 0x5d:
+      //  Selecting the memory bank starts reading from the top of the record
+      correlationPointer = 0;
+      registers[reg] = value;
+    break;
+    case 0x1e:
+      //  The new address only takes if the serial number was written first
+      if(registers[0x18] == (serialNumber & 0xff) && registers[0x19] == (serialNumber >> 8)){
+        address = registers[0x1a];
+      }
+      primaryDisabled = (value & 0x08) != 0;
+      registers[reg] = value;
+    break;
+    default:
+      registers[reg] = value;
+    break;
+  }
+}
+
+void FakeLidarLite::request(byte *data, int length){
+  byte reg = registerPointer & 0x7f;
+  bool autoIncrement = (registerPointer & 0x80) != 0;
+  if(reg == 0x52 && length == 2){
+    if(registers[0x40] != 0x07){
+      readsOutsideTestMode++;
+      data[0] = 0xff;
+      data[1] = 0xff;
+      return;
+    }
+    //  Low byte is the value, high byte is 1 for a negative value
+    int sample = correlationSample(correlationPointer++ % 1024);
+    data[0] = sample & 0xff;
+    data[1] = sample < 0 ? 1 : 0;
+    return;
+  }
+  for(int i = 0; i < length; i++){
+    data[i] = readRegister(reg);
+    if(autoIncrement){
+      reg++;
+    }
+  }
+}
+
+int FakeLidarLite::correlationSample(int index){
+  return (index * 37) % 255 - 127;
+}
+
+unsigned long FakeLidarLite::acquisitionTime(){
+  return 500 + 25UL * registers[0x02];
+}
+
+void FakeLidarLite::brownOut(){
+  powerUp();
+}
+
+void FakeLidarLite::powerUp(){
+  powered = true;
+  if(!faultSurvivesPowerCycle){
+    fault = NoFault;
+  }
+  address = 0x62;
+  primaryDisabled = false;
+  busyUntil = 0;
+  resetRegisters();
+}
+
+void FakeLidarLite::resetRegisters(){
+  memset(registers, 0, sizeof(registers));
+  registers[0x02] = 0x80;
+  registers[0x45] = 0xc8;
+  registers[0x16] = serialNumber & 0xff;
+  registers[0x17] = serialNumber >> 8;
+}
+
+void FakeLidarLite::startAcquisition(bool stabilize){
+  acquisitions++;
+  if(stabilize){
+    stabilizedAcquisitions++;
+  }
+  busyUntil = shim::now() + acquisitionTime() + (stabilize ? 600 : 0);
+  int count = registers[0x02] > 0 ? registers[0x02] : 1;
+  if(count < dropoutBelowCount && uniform() < dropoutRate){
+    distance = 0;
+    return;
+  }
+  distance = (int)floor(targetDistance + gaussian() * noise * sqrt(128.0 / count) + 0.5);
+}
+
+//  Fixed seed linear congruential generator so every run sees the same noise
+double FakeLidarLite::uniform(){
+  randomState = randomState * 6364136223846793005ULL + 1442695040888963407ULL;
+  return ((randomState >> 11) + 0.5) / 9007199254740992.0;
+}
+
+double FakeLidarLite::gaussian(){
+  return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+bool FakeLidarLite::busy(){
+  return fault == BusyStuck || shim::now() < busyUntil;
+}
+
+byte FakeLidarLite::readRegister(byte reg){
+  switch(reg){
+    case 0x01: return busy() ? 0x01 : 0x00;
+    case 0x0f: return (distance >> 8) & 0xff;
+    case 0x10: return distance & 0xff;
+  }
+  return registers[reg];
+}
+
+void FakeLidarLite::pinChanged(int pin, int level){
+  std::vector<FakeLidarLite *> &registered = sensors();
+  for(size_t i = 0; i < registered.size(); i++){
+    FakeLidarLite *sensor = registered[i];
+    if(sensor->pwrEnPin != pin){
+      continue;
+    }
+    if(level == LOW){
+      sensor->powered = false;
+    }else if(!sensor->powered){
+      sensor->powerUp();
+    }
+  }
+}
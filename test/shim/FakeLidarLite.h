@@ -0,0 +1,84 @@
+/* =============================================================================
+  Simulated LIDAR-Lite v2 on the shim I2C bus
+
+  Models the registers the library touches: the acquisition command and busy
+  flag, the distance result, the I2C address change sequence and power through
+  a PWR_EN pin. A sensor powered through a PWR_EN pin starts off and comes up
+  at 0x62 whenever that pin goes HIGH, exactly like the real unit.
+============================================================================= */
+#ifndef FakeLidarLite_h
+#define FakeLidarLite_h
+
+#include "Wire.h"
+
+class FakeLidarLite : public shim::I2cDevice
+{
+  public:
+      FakeLidarLite(int pwrEnPin = -1, unsigned int serialNumber = 0x1234);
+      ~FakeLidarLite();
+
+      bool answers(int address);
+      void receive(const byte *data, int length);
+      void request(byte *data, int length);
+
+      //  Distance every acquisition reports, in cm
+      int targetDistance;
+      //  Standard deviation of the reported distance at the default acquisition
+      //  count (0x80), it grows as the square root of 0x80 / count
+      float noise;
+      //  Below dropoutBelowCount acquisitions a reading comes back as 0 with
+      //  probability dropoutRate
+      byte dropoutBelowCount;
+      float dropoutRate;
+
+      bool powered;
+      int address;
+      bool primaryDisabled;
+      byte registers[256];
+
+      //  Number of acquisitions started (and of those, with DC stabilization)
+      //  and registers written
+      unsigned long acquisitions;
+      unsigned long stabilizedAcquisitions;
+      unsigned long registerWrites[256];
+
+      //  Time an acquisition keeps the busy flag set, in microseconds
+      unsigned long acquisitionTime();
+
+      //  Fault injection. NoAnswer stops the sensor acknowledging anything,
+      //  BusyStuck keeps it acknowledging with the busy flag always set. A
+      //  power cycle clears the fault unless faultSurvivesPowerCycle is set, a
+      //  reset (0x00 to 0x00) only if faultClearedByReset is set.
+      enum Fault { NoFault, NoAnswer, BusyStuck };
+      Fault fault;
+      bool faultClearedByReset;
+      bool faultSurvivesPowerCycle;
+      //  Correlation record sample i is correlationSample(i). Reads of 0xd2
+      //  outside test mode (0x07 in register 0x40) return 0xff and are counted.
+      static int correlationSample(int index);
+      unsigned long readsOutsideTestMode;
+
+      //  Power dips without the PWR_EN pin changing, the sensor comes back at
+      //  0x62 with its address change lost
+      void brownOut();
+
+  private:
+      void powerUp();
+      void resetRegisters();
+      void startAcquisition(bool stabilize);
+      bool busy();
+      byte readRegister(byte reg);
+      double uniform();
+      double gaussian();
+      static void pinChanged(int pin, int level);
+
+      int pwrEnPin;
+      unsigned int serialNumber;
+      byte registerPointer;
+      unsigned long long busyUntil;
+      int distance;
+      int correlationPointer;
+      unsigned long long randomState;
+};
+
+#endif
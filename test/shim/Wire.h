@@ -0,0 +1,48 @@
+/* =============================================================================
+  Linux stand-in for the Arduino Wire library. Transactions are handed to the
+  simulated devices registered with shim::I2cDevice, and each one advances
+  simulated time by what it would take on the wire at the selected clock.
+============================================================================= */
+#ifndef Wire_h
+#define Wire_h
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+
+class TwoWire
+{
+  public:
+      void begin();
+      void setClock(unsigned long);
+      void beginTransmission(int);
+      size_t write(int);
+      int endTransmission();
+      int requestFrom(int, int);
+      int available();
+      int read();
+};
+
+extern TwoWire Wire;
+
+namespace shim
+{
+  //  A simulated I2C slave. The bus asks every registered device whether it
+  //  answers an address, so several devices can share one (party line).
+  class I2cDevice
+  {
+    public:
+      I2cDevice();
+      virtual ~I2cDevice();
+      virtual bool answers(int address) = 0;
+      virtual void receive(const byte *data, int length) = 0;
+      virtual void request(byte *data, int length) = 0;
+  };
+
+  //  Clock selected by the last Wire.begin()/Wire.setClock()
+  unsigned long i2cClock();
+  //  Number of transactions that were not acknowledged
+  unsigned long i2cNacks();
+}
+
+#endif
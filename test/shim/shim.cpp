@@ -0,0 +1,226 @@
+#include "Arduino.h"
+#include "Wire.h"
+
+#include <vector>
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+namespace
+{
+  const int numberOfPins = 70;
+  const int numberOfInterrupts = 6;
+
+  unsigned long long currentMicros = 0;
+  int pinLevels[numberOfPins];
+  int pinOutputs[numberOfPins];
+  void (*interruptHandlers[numberOfInterrupts])();
+  int interruptModes[numberOfInterrupts];
+  bool interruptsEnabled = true;
+  void (*digitalWriteHook)(int, int) = 0;
+
+  std::vector<shim::I2cDevice *> &devices(){
+    static std::vector<shim::I2cDevice *> registered;
+    return registered;
+  }
+  unsigned long clock = 100000;
+  unsigned long nacks = 0;
+  int txAddress = 0;
+  std::vector<byte> txBuffer;
+  std::vector<byte> rxBuffer;
+  size_t rxPosition = 0;
+
+  //  Start, address byte, data bytes with their ACK bits, stop
+  void busTime(int dataBytes){
+    currentMicros += ((dataBytes + 1) * 9 + 2) * 1000000ULL / clock + 1;
+  }
+
+  bool validPin(int pin){
+    return pin >= 0 && pin < numberOfPins;
+  }
+
+  void fireInterrupt(int pin, int oldLevel, int newLevel){
+    int interruptNumber = digitalPinToInterrupt(pin);
+    if(interruptNumber < 0 || !interruptHandlers[interruptNumber] || !interruptsEnabled){
+      return;
+    }
+    int mode = interruptModes[interruptNumber];
+    if(oldLevel == newLevel){
+      return;
+    }
+    if(mode == CHANGE || (mode == RISING && newLevel == HIGH) || (mode == FALLING && newLevel == LOW)){
+      interruptHandlers[interruptNumber]();
+    }
+  }
+}
+
+unsigned long micros(){ return (unsigned long)(uint32_t)currentMicros; }
+unsigned long millis(){ return (unsigned long)(uint32_t)(currentMicros / 1000); }
+void delay(unsigned long ms){ currentMicros += ms * 1000ULL; }
+void delayMicroseconds(unsigned int us){ currentMicros += us; }
+
+void pinMode(int, int){}
+
+void digitalWrite(int pin, int level){
+  if(!validPin(pin)){
+    return;
+  }
+  pinOutputs[pin] = level;
+  if(digitalWriteHook){
+    digitalWriteHook(pin, level);
+  }
+}
+
+int digitalRead(int pin){
+  return validPin(pin) ? pinLevels[pin] : LOW;
+}
+
+//  Same pin to interrupt mapping as the Arduino Mega
+int digitalPinToInterrupt(int pin){
+  switch(pin){
+    case 2: return 0;
+    case 3: return 1;
+    case 21: return 2;
+    case 20: return 3;
+    case 19: return 4;
+    case 18: return 5;
+  }
+  return NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(int interruptNumber, void (*handler)(), int mode){
+  if(interruptNumber >= 0 && interruptNumber < numberOfInterrupts){
+    interruptHandlers[interruptNumber] = handler;
+    interruptModes[interruptNumber] = mode;
+  }
+}
+
+void detachInterrupt(int interruptNumber){
+  if(interruptNumber >= 0 && interruptNumber < numberOfInterrupts){
+    interruptHandlers[interruptNumber] = 0;
+  }
+}
+
+void noInterrupts(){ interruptsEnabled = false; }
+void interrupts(){ interruptsEnabled = true; }
+
+void TwoWire::begin(){ clock = 100000; }
+void TwoWire::setClock(unsigned long frequency){ clock = frequency; }
+
+void TwoWire::beginTransmission(int address){
+  txAddress = address;
+  txBuffer.clear();
+}
+
+size_t TwoWire::write(int value){
+  txBuffer.push_back((byte)value);
+  return 1;
+}
+
+int TwoWire::endTransmission(){
+  busTime(txBuffer.size());
+  bool acknowledged = false;
+  std::vector<shim::I2cDevice *> listeners = devices();
+  for(size_t i = 0; i < listeners.size(); i++){
+    if(listeners[i]->answers(txAddress)){
+      listeners[i]->receive(txBuffer.empty() ? 0 : &txBuffer[0], txBuffer.size());
+      acknowledged = true;
+    }
+  }
+  if(!acknowledged){
+    nacks++;
+    return 2;
+  }
+  return 0;
+}
+
+int TwoWire::requestFrom(int address, int quantity){
+  rxBuffer.clear();
+  rxPosition = 0;
+  if(quantity > BUFFER_LENGTH){
+    quantity = BUFFER_LENGTH;
+  }
+  std::vector<shim::I2cDevice *> &listeners = devices();
+  for(size_t i = 0; i < listeners.size(); i++){
+    if(listeners[i]->answers(address)){
+      rxBuffer.resize(quantity);
+      listeners[i]->request(&rxBuffer[0], quantity);
+      break;
+    }
+  }
+  busTime(rxBuffer.size());
+  if(rxBuffer.empty()){
+    nacks++;
+  }
+  return rxBuffer.size();
+}
+
+int TwoWire::available(){
+  return rxBuffer.size() - rxPosition;
+}
+
+int TwoWire::read(){
+  if(rxPosition >= rxBuffer.size()){
+    return -1;
+  }
+  return rxBuffer[rxPosition++];
+}
+
+namespace shim
+{
+  I2cDevice::I2cDevice(){
+    devices().push_back(this);
+  }
+
+  I2cDevice::~I2cDevice(){
+    std::vector<I2cDevice *> &registered = devices();
+    for(size_t i = 0; i < registered.size(); i++){
+      if(registered[i] == this){
+        registered.erase(registered.begin() + i);
+        break;
+      }
+    }
+  }
+
+  unsigned long i2cClock(){ return clock; }
+  unsigned long i2cNacks(){ return nacks; }
+
+  void reset(){
+    currentMicros = 0;
+    memset(pinLevels, 0, sizeof(pinLevels));
+    memset(pinOutputs, 0, sizeof(pinOutputs));
+    memset(interruptHandlers, 0, sizeof(interruptHandlers));
+    memset(interruptModes, 0, sizeof(interruptModes));
+    interruptsEnabled = true;
+    digitalWriteHook = 0;
+    clock = 100000;
+    nacks = 0;
+  }
+
+  void advance(unsigned long microseconds){ currentMicros += microseconds; }
+  void setMicros(unsigned long long microseconds){ currentMicros = microseconds; }
+  unsigned long long now(){ return currentMicros; }
+
+  void setPin(int pin, int level){
+    if(!validPin(pin)){
+      return;
+    }
+    int oldLevel = pinLevels[pin];
+    pinLevels[pin] = level;
+    fireInterrupt(pin, oldLevel, level);
+  }
+
+  int outputLevel(int pin){
+    return validPin(pin) ? pinOutputs[pin] : LOW;
+  }
+
+  void onDigitalWrite(void (*hook)(int, int)){
+    digitalWriteHook = hook;
+  }
+
+  void pulse(int pin, unsigned long width){
+    setPin(pin, HIGH);
+    advance(width);
+    setPin(pin, LOW);
+  }
+}
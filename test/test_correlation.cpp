@@ -0,0 +1,222 @@
+#include "check.h"
+#include "FakeLidarLite.h"
+#include "LIDARLite.h"
+#include "LIDARLiteHealth.h"
+
+static const int bufferLength = 16;
+static int16_t firstBuffer[bufferLength];
+static int16_t secondBuffer[bufferLength];
+
+//  Everything the callback was handed, and a copy of the previous buffer taken
+//  when it was handed over
+static int16_t received[1024];
+static int receivedCount;
+static int callbacks;
+static bool offsetsInOrder;
+static bool previousBufferIntact;
+static int16_t *previousBuffer;
+static int16_t previousCopy[bufferLength];
+static int previousLength;
+static FakeLidarLite *failInCallback;
+
+static void collect(int16_t *samples, int numberOfSamples, int firstSample){
+  if(firstSample != receivedCount){
+    offsetsInOrder = false;
+  }
+  if(previousBuffer && memcmp(previousBuffer, previousCopy, previousLength * sizeof(int16_t)) != 0){
+    previousBufferIntact = false;
+  }
+  memcpy(received + receivedCount, samples, numberOfSamples * sizeof(int16_t));
+  receivedCount += numberOfSamples;
+  callbacks++;
+  previousBuffer = samples;
+  memcpy(previousCopy, samples, numberOfSamples * sizeof(int16_t));
+  previousLength = numberOfSamples;
+  if(failInCallback){
+    failInCallback->fault = FakeLidarLite::NoAnswer;
+  }
+}
+
+static void clearReceived(){
+  receivedCount = 0;
+  callbacks = 0;
+  offsetsInOrder = true;
+  previousBufferIntact = true;
+  previousBuffer = 0;
+  previousLength = 0;
+  failInCallback = 0;
+}
+
+static bool matchesRecord(int count){
+  for(int i = 0; i < count; i++){
+    if(received[i] != FakeLidarLite::correlationSample(i)){
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(streamDeliversRecordInOrder){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  lidarLite.begin();
+  lidarLite.distance();
+  clearReceived();
+
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 100));
+  CHECK_EQUAL(100, receivedCount);
+  CHECK_EQUAL(7, callbacks);
+  CHECK(offsetsInOrder);
+  CHECK(matchesRecord(100));
+  CHECK(previousBufferIntact);
+  CHECK_EQUAL(0, fakeLidarLite.readsOutsideTestMode);
+}
+
+TEST(consecutiveStreamsSelectTestModeOnce){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  lidarLite.begin();
+  for(int i = 0; i < 5; i++){
+    lidarLite.distance();
+    clearReceived();
+    CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 64));
+    CHECK(matchesRecord(64));
+  }
+  CHECK_EQUAL(1, fakeLidarLite.registerWrites[0x40]);
+
+  lidarLite.correlationRecordStreamEnd();
+  CHECK_EQUAL(2, fakeLidarLite.registerWrites[0x40]);
+  CHECK_EQUAL(0x00, fakeLidarLite.registers[0x40]);
+}
+
+TEST(resetSelectsTestModeAgain){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  lidarLite.begin();
+  lidarLite.distance();
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32));
+
+  //  configure(0) resets the sensor
+  lidarLite.configure(0);
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32));
+  CHECK(matchesRecord(32));
+  CHECK_EQUAL(2, fakeLidarLite.registerWrites[0x40]);
+
+  //  begin() resets it too
+  lidarLite.begin();
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32));
+  CHECK(matchesRecord(32));
+  CHECK_EQUAL(3, fakeLidarLite.registerWrites[0x40]);
+
+  //  A power cycle behind the library's back, followed by changeAddress()
+  fakeLidarLite.brownOut();
+  lidarLite.changeAddress(0x66, false);
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32, 0x66));
+  CHECK(matchesRecord(32));
+  CHECK_EQUAL(4, fakeLidarLite.registerWrites[0x40]);
+
+  CHECK_EQUAL(0, fakeLidarLite.readsOutsideTestMode);
+}
+
+TEST(nullCallbackIsRejected){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  lidarLite.begin();
+  lidarLite.distance();
+  CHECK(!lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, 0, 64));
+  CHECK_EQUAL(0, fakeLidarLite.registerWrites[0x40]);
+}
+
+TEST(forgetOnlyTouchesTheCache){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  lidarLite.begin();
+  lidarLite.distance();
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32));
+  //  Another address leaves the cache alone
+  lidarLite.correlationRecordStreamForget(0x66);
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32));
+  CHECK_EQUAL(1, fakeLidarLite.registerWrites[0x40]);
+
+  lidarLite.correlationRecordStreamForget();
+  CHECK_EQUAL(1, fakeLidarLite.registerWrites[0x40]);
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32));
+  CHECK(matchesRecord(32));
+  CHECK_EQUAL(2, fakeLidarLite.registerWrites[0x40]);
+}
+
+TEST(healthPowerCycleForgetsTestModeWithoutBusTraffic){
+  FakeLidarLite front(2, 0x1111);
+  FakeLidarLite middle(3, 0x2222);
+  LIDARLite lidarLite;
+  LIDARLiteHealth health(lidarLite);
+  lidarLite.begin();
+  health.addSensor(0x66, 2);
+  health.addSensor(0x68, 3);
+  health.begin();
+
+  lidarLite.distance(true, 0x68);
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32, 0x68));
+  CHECK_EQUAL(1, middle.registerWrites[0x40]);
+
+  //  Recovery of the streaming sensor by power cycle
+  middle.fault = FakeLidarLite::BusyStuck;
+  health.distance(1);
+  health.distance(1);
+  CHECK(health.quarantined(1));
+  delay(1000);
+  CHECK(health.service());
+  //  No test mode traffic to either sensor during the recovery
+  CHECK_EQUAL(1, middle.registerWrites[0x40]);
+  CHECK_EQUAL(0, front.registerWrites[0x40]);
+
+  //  The next stream selects test mode again
+  lidarLite.distance(true, 0x68);
+  clearReceived();
+  CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 32, 0x68));
+  CHECK(matchesRecord(32));
+  CHECK_EQUAL(2, middle.registerWrites[0x40]);
+  CHECK_EQUAL(0, middle.readsOutsideTestMode);
+}
+
+TEST(failedReadStopsRecord){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  lidarLite.begin();
+  lidarLite.distance();
+  clearReceived();
+  failInCallback = &fakeLidarLite;
+
+  CHECK(!lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 256));
+  //  Only the first full buffer, nothing read after the sensor went away
+  CHECK_EQUAL(1, callbacks);
+  CHECK_EQUAL(bufferLength, receivedCount);
+  CHECK(matchesRecord(bufferLength));
+}
+
+TEST(streamBufferSizeAndThroughput){
+  long clocks[] = {100000, 400000};
+  for(int c = 0; c < 2; c++){
+    FakeLidarLite fakeLidarLite;
+    LIDARLite lidarLite;
+    lidarLite.begin(0, clocks[c] == 400000);
+    lidarLite.distance();
+    clearReceived();
+    unsigned long long start = shim::now();
+    CHECK(lidarLite.correlationRecordStream(firstBuffer, secondBuffer, bufferLength, collect, 1024));
+    double seconds = (shim::now() - start) / 1000000.0;
+    CHECK_EQUAL(1024, receivedCount);
+    CHECK(matchesRecord(1024));
+    printf("  %ld Hz: 1024 samples in %.1f ms, %.0f samples/s\n", clocks[c], seconds * 1000, 1024 / seconds);
+  }
+  //  Against 256 ints on an AVR for correlationRecordToArray()'s default
+  printf("  buffers: %d bytes, correlationRecordToArray(): %d bytes on AVR\n", (int)(2 * bufferLength * sizeof(int16_t)), 256 * 2);
+  CHECK_EQUAL(64, (int)(sizeof(firstBuffer) + sizeof(secondBuffer)));
+}
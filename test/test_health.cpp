@@ -0,0 +1,176 @@
+#include "check.h"
+#include "FakeLidarLite.h"
+#include "LIDARLite.h"
+#include "LIDARLiteHealth.h"
+
+//  Three sensors wired as in the Multi-sensor PWR_EN diagram
+struct Rig
+{
+  FakeLidarLite front;
+  FakeLidarLite middle;
+  FakeLidarLite back;
+  LIDARLite lidarLite;
+  LIDARLiteHealth health;
+
+  Rig() : front(2, 0x1111), middle(3, 0x2222), back(4, 0x3333), health(lidarLite){
+    front.targetDistance = 100;
+    middle.targetDistance = 200;
+    back.targetDistance = 300;
+    lidarLite.begin();
+    health.addSensor(0x66, 2);
+    health.addSensor(0x68, 3);
+    health.addSensor(0x64, 4, 3);
+    health.begin();
+  }
+
+  //  One pass of a sketch's loop(), returns the number of good readings
+  int loop(){
+    int good = 0;
+    for(int i = 0; i < 3; i++){
+      if(health.distance(i) > 0){
+        good++;
+      }
+    }
+    health.service();
+    return good;
+  }
+};
+
+//  Readings per second of simulated time over a number of loop() passes
+static double healthyRate(Rig &rig, int passes, int sensorIndex){
+  unsigned long readsBefore = rig.health.readCount(sensorIndex) - rig.health.failureCount(sensorIndex);
+  unsigned long long start = shim::now();
+  for(int i = 0; i < passes; i++){
+    rig.loop();
+  }
+  unsigned long reads = rig.health.readCount(sensorIndex) - rig.health.failureCount(sensorIndex) - readsBefore;
+  return reads * 1000000.0 / (shim::now() - start);
+}
+
+TEST(beginAssignsAddressesAndConfiguration){
+  Rig rig;
+  CHECK_EQUAL(0x66, rig.front.address);
+  CHECK_EQUAL(0x68, rig.middle.address);
+  CHECK_EQUAL(0x64, rig.back.address);
+  CHECK(rig.front.primaryDisabled && rig.middle.primaryDisabled && rig.back.primaryDisabled);
+  CHECK_EQUAL(0x60, rig.back.registers[0x1c]);
+  CHECK_EQUAL(100, rig.health.distance(0));
+  CHECK_EQUAL(200, rig.health.distance(1));
+  CHECK_EQUAL(300, rig.health.distance(2));
+  for(int i = 0; i < 3; i++){
+    CHECK(!rig.health.quarantined(i));
+  }
+}
+
+TEST(failedReadIsBoundedByReadTimeout){
+  Rig rig;
+  rig.middle.fault = FakeLidarLite::BusyStuck;
+  unsigned long long start = shim::now();
+  CHECK_EQUAL(-1, rig.health.distance(1));
+  unsigned long long stuckTime = shim::now() - start;
+  printf("  busy stuck read failed after %llu us\n", stuckTime);
+  CHECK(stuckTime >= 20000 && stuckTime < 22000);
+
+  rig.middle.fault = FakeLidarLite::NoAnswer;
+  start = shim::now();
+  CHECK_EQUAL(-1, rig.health.distance(1));
+  unsigned long long silentTime = shim::now() - start;
+  printf("  unanswered read failed after %llu us\n", silentTime);
+  CHECK(silentTime >= 20000 && silentTime < 22000);
+}
+
+TEST(quarantinedSensorWaitsForRetryInterval){
+  Rig rig;
+  rig.middle.fault = FakeLidarLite::BusyStuck;
+  rig.health.distance(1);
+  CHECK(!rig.health.quarantined(1));
+  rig.health.distance(1);
+  CHECK(rig.health.quarantined(1));
+
+  unsigned long acquisitions = rig.middle.acquisitions;
+  unsigned long long start = shim::now();
+  CHECK_EQUAL(-1, rig.health.distance(1));
+  CHECK(!rig.health.service());
+  CHECK_EQUAL(acquisitions, rig.middle.acquisitions);
+  CHECK(shim::now() == start);
+}
+
+TEST(stuckSensorThatKeepsAcknowledgingStaysQuarantined){
+  Rig rig;
+  double baseline = healthyRate(rig, 50, 0);
+
+  //  Acknowledges every transaction with the busy flag set, power cycling
+  //  does not help
+  rig.middle.fault = FakeLidarLite::BusyStuck;
+  rig.middle.faultSurvivesPowerCycle = true;
+  unsigned long long start = shim::now();
+  double duringFault = healthyRate(rig, 2000, 0);
+  double seconds = (shim::now() - start) / 1000000.0;
+
+  printf("  healthy sensor: %.0f reads/s before, %.0f reads/s with a stuck neighbour over %.1f s\n", baseline, duringFault, seconds);
+  CHECK(rig.health.quarantined(1));
+  CHECK_EQUAL(0, rig.health.recoveryCount(1));
+  CHECK_EQUAL(2, rig.health.failureCount(1));
+  CHECK(rig.health.failureCount(0) == 0 && rig.health.failureCount(2) == 0);
+  //  Recovery attempts once a second are the only cost left
+  CHECK(duringFault > baseline * 0.9);
+}
+
+TEST(stuckSensorRecoversByPowerCycle){
+  Rig rig;
+  rig.middle.fault = FakeLidarLite::BusyStuck;
+  int passes = 0;
+  while(rig.health.recoveryCount(1) == 0 && passes < 10000){
+    rig.loop();
+    passes++;
+  }
+  printf("  recovered after %d passes, recovery took %lu ms\n", passes, rig.health.recoveryTime(1));
+  CHECK_EQUAL(1, rig.health.recoveryCount(1));
+  CHECK(!rig.health.quarantined(1));
+  CHECK(rig.health.recoveryTime(1) > 0 && rig.health.recoveryTime(1) < 100);
+  //  The power cycle put it back at 0x62, the cached address was re-applied
+  CHECK_EQUAL(0x68, rig.middle.address);
+  CHECK(rig.middle.primaryDisabled);
+  CHECK_EQUAL(200, rig.health.distance(1));
+}
+
+TEST(stuckSensorWithoutPwrEnRecoversByReset){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  LIDARLiteHealth health(lidarLite);
+  lidarLite.begin();
+  health.addSensor(0x62);
+  health.begin();
+  CHECK_EQUAL(200, health.distance(0));
+
+  fakeLidarLite.fault = FakeLidarLite::BusyStuck;
+  fakeLidarLite.faultClearedByReset = true;
+  health.distance(0);
+  health.distance(0);
+  CHECK(health.quarantined(0));
+  delay(1000);
+  CHECK(health.service());
+  CHECK(!health.quarantined(0));
+  CHECK_EQUAL(200, health.distance(0));
+}
+
+TEST(brownOutRestoresAddressAndConfiguration){
+  Rig rig;
+  rig.back.brownOut();
+  CHECK_EQUAL(0x62, rig.back.address);
+  CHECK_EQUAL(0x00, rig.back.registers[0x1c]);
+
+  int passes = 0;
+  while(rig.health.recoveryCount(2) == 0 && passes < 10000){
+    rig.loop();
+    passes++;
+  }
+  printf("  recovered after %d passes, recovery took %lu ms\n", passes, rig.health.recoveryTime(2));
+  CHECK_EQUAL(1, rig.health.recoveryCount(2));
+  CHECK_EQUAL(0x64, rig.back.address);
+  CHECK(rig.back.primaryDisabled);
+  CHECK_EQUAL(0x60, rig.back.registers[0x1c]);
+  CHECK_EQUAL(300, rig.health.distance(2));
+  //  The others never noticed
+  CHECK(rig.health.failureCount(0) == 0 && rig.health.failureCount(1) == 0);
+}
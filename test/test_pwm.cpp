@@ -0,0 +1,188 @@
+#include "check.h"
+#include "FakeLidarLite.h"
+#include "LIDARLite.h"
+#include "LIDARLitePWM.h"
+
+//  Monitor and trigger pins from the PWM wiring diagram
+const int monitorPin = 3;
+const int triggerPin = 2;
+
+TEST(beginPullsTriggerLowAndCapturesPulses){
+  LIDARLitePWM lidarLitePWM;
+  digitalWrite(triggerPin, HIGH);
+  CHECK(lidarLitePWM.begin(monitorPin, triggerPin));
+  CHECK_EQUAL(LOW, shim::outputLevel(triggerPin));
+
+  shim::advance(1000);
+  shim::pulse(monitorPin, 1230);
+  shim::advance(4000);
+  shim::pulse(monitorPin, 4560);
+  CHECK_EQUAL(2, lidarLitePWM.available());
+  CHECK_EQUAL(123, lidarLitePWM.distance());
+  CHECK_EQUAL(456, lidarLitePWM.distance());
+  CHECK_EQUAL(-1, lidarLitePWM.distance());
+  lidarLitePWM.end();
+}
+
+TEST(beginRejectsPinWithoutInterrupt){
+  LIDARLitePWM lidarLitePWM;
+  CHECK(!lidarLitePWM.begin(7));
+}
+
+TEST(pulseAcrossMicrosRolloverIsTimedCorrectly){
+  LIDARLitePWM lidarLitePWM;
+  CHECK(lidarLitePWM.begin(monitorPin));
+  //  micros() wraps from 0xffffffff to 0 part way through the pulse
+  shim::setMicros(0xffffffffULL - 300);
+  shim::pulse(monitorPin, 2000);
+  CHECK(micros() < 2000);
+  CHECK_EQUAL(2000, lidarLitePWM.pulseWidth());
+
+  lidarLitePWM.handleEdge(true, 0xffffff00UL);
+  lidarLitePWM.handleEdge(false, 0x00000100UL);
+  CHECK_EQUAL(0x200, lidarLitePWM.pulseWidth());
+  lidarLitePWM.end();
+}
+
+TEST(fullBufferDropsOldestAndCountsOverruns){
+  LIDARLitePWM lidarLitePWM;
+  unsigned long timestamp = 0;
+  for(int i = 0; i < LIDARLITE_PWM_BUFFER_SIZE + 3; i++){
+    lidarLitePWM.handleEdge(true, timestamp);
+    timestamp += 1000 + i * 10;
+    lidarLitePWM.handleEdge(false, timestamp);
+    timestamp += 500;
+  }
+  CHECK_EQUAL(LIDARLITE_PWM_BUFFER_SIZE, lidarLitePWM.available());
+  CHECK_EQUAL(3, lidarLitePWM.overruns());
+  //  The three oldest (100, 101 and 102 cm) are gone
+  CHECK_EQUAL(103, lidarLitePWM.distance());
+  CHECK_EQUAL(104, lidarLitePWM.distance());
+}
+
+TEST(setBufferUsesCallerStorage){
+  static volatile unsigned int widths[32];
+  LIDARLitePWM lidarLitePWM;
+  CHECK(!lidarLitePWM.setBuffer(widths, 24));
+  CHECK(!lidarLitePWM.setBuffer(widths, 256));
+  CHECK(!lidarLitePWM.setBuffer(0, 32));
+  CHECK(lidarLitePWM.setBuffer(widths, 32));
+  unsigned long timestamp = 0;
+  for(int i = 0; i < 35; i++){
+    lidarLitePWM.handleEdge(true, timestamp);
+    timestamp += 1000 + i * 10;
+    lidarLitePWM.handleEdge(false, timestamp);
+    timestamp += 500;
+  }
+  CHECK_EQUAL(32, lidarLitePWM.available());
+  CHECK_EQUAL(3, lidarLitePWM.overruns());
+  CHECK_EQUAL(103, lidarLitePWM.distance());
+  CHECK_EQUAL(1030, widths[3]);
+}
+
+TEST(distanceLatestReturnsNewestAndEmptiesBuffer){
+  LIDARLitePWM lidarLitePWM;
+  lidarLitePWM.handleEdge(true, 0);
+  lidarLitePWM.handleEdge(false, 1500);
+  lidarLitePWM.handleEdge(true, 5000);
+  lidarLitePWM.handleEdge(false, 7770);
+  CHECK_EQUAL(277, lidarLitePWM.distanceLatest());
+  CHECK_EQUAL(0, lidarLitePWM.available());
+  CHECK_EQUAL(-1, lidarLitePWM.distanceLatest());
+}
+
+TEST(glitchesAreRejected){
+  LIDARLitePWM lidarLitePWM;
+  //  Longer than any real measurement
+  lidarLitePWM.handleEdge(true, 0);
+  lidarLitePWM.handleEdge(false, 45001);
+  //  Falling edge with no rising edge before it
+  lidarLitePWM.handleEdge(false, 50000);
+  //  Zero width
+  lidarLitePWM.handleEdge(true, 60000);
+  lidarLitePWM.handleEdge(false, 60000);
+  CHECK_EQUAL(0, lidarLitePWM.available());
+  //  The longest accepted pulse still gets through
+  lidarLitePWM.handleEdge(true, 70000);
+  lidarLitePWM.handleEdge(false, 115000);
+  CHECK_EQUAL(4500, lidarLitePWM.distance());
+}
+
+TEST(sensorsOnDifferentPinsAreCapturedSeparately){
+  LIDARLitePWM sensors[LIDARLITE_PWM_MAX_SENSORS];
+  int pins[] = {2, 3, 18, 19};
+  for(int i = 0; i < LIDARLITE_PWM_MAX_SENSORS; i++){
+    CHECK(sensors[i].begin(pins[i]));
+  }
+  LIDARLitePWM oneTooMany;
+  CHECK(!oneTooMany.begin(20));
+
+  for(int i = 0; i < LIDARLITE_PWM_MAX_SENSORS; i++){
+    shim::pulse(pins[i], 1000 * (i + 1));
+    shim::advance(100);
+  }
+  for(int i = 0; i < LIDARLITE_PWM_MAX_SENSORS; i++){
+    CHECK_EQUAL(1, sensors[i].available());
+    CHECK_EQUAL(100 * (i + 1), sensors[i].distance());
+  }
+
+  //  Freeing a slot makes room for another sensor
+  sensors[0].end();
+  CHECK(oneTooMany.begin(20));
+  oneTooMany.end();
+  for(int i = 1; i < LIDARLITE_PWM_MAX_SENSORS; i++){
+    sensors[i].end();
+  }
+}
+
+TEST(secondInstanceCannotClaimSamePin){
+  LIDARLitePWM first;
+  LIDARLitePWM second;
+  CHECK(first.begin(monitorPin));
+  CHECK(!second.begin(monitorPin));
+  shim::pulse(monitorPin, 1500);
+  CHECK_EQUAL(150, first.distance());
+  CHECK_EQUAL(-1, second.distance());
+
+  //  Restarting the owner on its own pin is fine
+  CHECK(first.begin(monitorPin));
+  shim::pulse(monitorPin, 1600);
+  CHECK_EQUAL(160, first.distance());
+
+  //  The failed begin() left nothing to tear down the first capture
+  second.end();
+  shim::pulse(monitorPin, 1700);
+  CHECK_EQUAL(170, first.distance());
+  first.end();
+}
+
+TEST(failedBeginKeepsRunningCapture){
+  LIDARLitePWM sensors[LIDARLITE_PWM_MAX_SENSORS];
+  int pins[] = {2, 3, 18, 19};
+  for(int i = 0; i < LIDARLITE_PWM_MAX_SENSORS; i++){
+    CHECK(sensors[i].begin(pins[i]));
+  }
+  //  Moving to a pin another instance owns fails, pin 2 keeps capturing
+  CHECK(!sensors[0].begin(3));
+  shim::pulse(2, 1200);
+  CHECK_EQUAL(120, sensors[0].distance());
+  //  Moving to a free pin reuses its own slot even though all are taken
+  CHECK(sensors[0].begin(20));
+  shim::pulse(20, 1300);
+  CHECK_EQUAL(130, sensors[0].distance());
+  for(int i = 0; i < LIDARLITE_PWM_MAX_SENSORS; i++){
+    sensors[i].end();
+  }
+}
+
+TEST(beginWithI2cConfiguresSensorFirst){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  LIDARLitePWM lidarLitePWM;
+  lidarLite.begin();
+  CHECK(lidarLitePWM.begin(lidarLite, 3, monitorPin, triggerPin));
+  CHECK_EQUAL(0x60, fakeLidarLite.registers[0x1c]);
+  shim::pulse(monitorPin, 2500);
+  CHECK_EQUAL(250, lidarLitePWM.distance());
+  lidarLitePWM.end();
+}
@@ -0,0 +1,88 @@
+#include "check.h"
+#include "FakeLidarLite.h"
+#include "LIDARLite.h"
+
+//  Fewer acquisitions are faster and noisier, below 0x10 readings start to
+//  drop out. Standard deviation is 0.5cm at 0x80, 0.71 at 0x40, 1.0 at 0x20,
+//  1.41 at 0x10 and 2.0 at 0x08.
+static void noisySensor(FakeLidarLite &fakeLidarLite){
+  fakeLidarLite.noise = 0.5;
+  fakeLidarLite.dropoutBelowCount = 0x10;
+  fakeLidarLite.dropoutRate = 0.3;
+}
+
+static const LIDARLiteProfile profiles[] = {
+  {0x80, 0x00, 1, 0xc8},
+  {0x40, 0x00, 10, 0xc8},
+  {0x20, 0x00, 100, 0xc8},
+  {0x10, 0x00, 100, 0xc8},
+  {0x08, 0x00, 100, 0xc8}
+};
+static const int numberOfProfiles = 5;
+
+TEST(tunePicksFastestProfileWithinNoiseBudget){
+  FakeLidarLite fakeLidarLite;
+  noisySensor(fakeLidarLite);
+  LIDARLite lidarLite;
+  lidarLite.begin(0, true);
+
+  LIDARLiteTuneResult results[numberOfProfiles];
+  int chosen = lidarLite.tune(profiles, numberOfProfiles, 1.2, results, 200);
+  for(int i = 0; i < numberOfProfiles; i++){
+    printf("  profile %d: %.1f Hz, noise %.2f cm, dropouts %.0f%%\n", i, results[i].hz, results[i].noise, results[i].dropoutRate * 100);
+  }
+
+  CHECK_EQUAL(2, chosen);
+  CHECK_EQUAL(0x20, fakeLidarLite.registers[0x02]);
+  //  Faster as the acquisition count drops
+  for(int i = 1; i < 4; i++){
+    CHECK(results[i].hz > results[i - 1].hz);
+  }
+  //  Noise follows the model
+  CHECK(results[0].noise > 0.4 && results[0].noise < 0.6);
+  CHECK(results[2].noise > 0.85 && results[2].noise < 1.15);
+  CHECK(results[3].noise > 1.25);
+  //  Only the lowest count drops readings, and dropouts cost it speed
+  for(int i = 0; i < 4; i++){
+    CHECK(results[i].dropoutRate == 0);
+  }
+  CHECK(results[4].dropoutRate > 0.2 && results[4].dropoutRate < 0.4);
+  CHECK(results[4].hz < results[3].hz);
+}
+
+TEST(tuneWithLooseBudgetPicksFastest){
+  FakeLidarLite fakeLidarLite;
+  noisySensor(fakeLidarLite);
+  LIDARLite lidarLite;
+  lidarLite.begin(0, true);
+  CHECK_EQUAL(3, lidarLite.tune(profiles, numberOfProfiles, 10.0, 0, 200));
+  CHECK_EQUAL(0x10, fakeLidarLite.registers[0x02]);
+}
+
+TEST(tuneRestoresRegistersWhenNoProfileQualifies){
+  FakeLidarLite fakeLidarLite;
+  noisySensor(fakeLidarLite);
+  LIDARLite lidarLite;
+  lidarLite.begin(0, true);
+  LIDARLiteProfile current = {0x60, 0x20, 1, 0x50};
+  lidarLite.configure(current);
+
+  CHECK_EQUAL(-1, lidarLite.tune(profiles, numberOfProfiles, 0.01, 0, 50));
+  CHECK_EQUAL(0x60, fakeLidarLite.registers[0x02]);
+  CHECK_EQUAL(0x20, fakeLidarLite.registers[0x1c]);
+  CHECK_EQUAL(0x50, fakeLidarLite.registers[0x45]);
+}
+
+TEST(distanceWithProfileStabilizesOneInEvery){
+  FakeLidarLite fakeLidarLite;
+  LIDARLite lidarLite;
+  lidarLite.begin();
+  LIDARLiteProfile profile = {0x40, 0x00, 10, 0xc8};
+  lidarLite.configure(profile);
+  CHECK_EQUAL(0x40, fakeLidarLite.registers[0x02]);
+  for(int i = 0; i < 30; i++){
+    CHECK_EQUAL(200, lidarLite.distance(profile));
+  }
+  CHECK_EQUAL(30, fakeLidarLite.acquisitions);
+  CHECK_EQUAL(3, fakeLidarLite.stabilizedAcquisitions);
+}